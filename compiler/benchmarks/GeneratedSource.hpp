@@ -0,0 +1,32 @@
+#pragma once
+
+#include <random>
+#include <string>
+
+/*
+A valid R-Sharp program of roughly `size` bytes made of many similar functions,
+shared by the benchmarks that need a large input.
+*/
+inline std::string generateSource(size_t size) {
+    std::mt19937 rng(1);
+    std::string source;
+    source.reserve(size + 1024);
+
+    for (size_t f = 0; source.size() < size; f++) {
+        source += "function_" + std::to_string(f) + "(a: i64, b: i64, values: *i64): i64 {\n";
+        source += "    result: i64 = 0;\n";
+        for (int s = 0; s < 20; s++) {
+            auto number = std::to_string(rng() % 1000);
+            switch (rng() % 6) {
+                case 0: source += "    result = result + a * " + number + " - b / (a % 7 + 1);\n"; break;
+                case 1: source += "    if (a <= " + number + " && b != 0 || !a) { return -b; } else { a = a + 1; }\n"; break;
+                case 2: source += "    for (i: i64 = 0; i < " + number + "; i = i + 1) { *values = *values + i; }\n"; break;
+                case 3: source += "    b = a > b ? function_0(a, b - 1, values) : ~b;\n"; break;
+                case 4: source += "    while (b != 0) { b = b - 1; result = (result + b) * 2; }\n"; break;
+                case 5: source += "    result = result == " + number + ";\n"; break;
+            }
+        }
+        source += "    return result;\n}\n\n";
+    }
+    return source;
+}
@@ -0,0 +1,90 @@
+#include "GeneratedSource.hpp"
+#include "R-Sharp/ast/AstNodes.hpp"
+#include "R-Sharp/frontend/Parser.hpp"
+#include "R-Sharp/frontend/ParsingCache.hpp"
+#include "R-Sharp/frontend/Tokenizer.hpp"
+#include "R-Sharp/frontend/Utils.hpp"
+#include "R-Sharp/Logging.hpp"
+#include "R-Sharp/Utils/AllocationCounter.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <sys/resource.h>
+
+/*
+Parses a generated R-Sharp file of a few megabytes and reports the throughput,
+the number of heap allocations per parse and the time it takes to free the AST.
+The AST arena is reset after every run, so the peak RSS is the one of a single parse.
+The file is tokenized once up front, only the parser is timed.
+
+usage: parser_benchmark [size in MB] [repetitions]
+*/
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 4;
+    int repetitions = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    auto path = std::filesystem::temp_directory_path() / "parser_benchmark.rs";
+    {
+        std::ofstream file(path);
+        file << generateSource(megabytes * 1024 * 1024);
+    }
+    auto fileSize = std::filesystem::file_size(path);
+
+    Tokenizer tokenizer(path);
+    auto tokens = tokenizer.tokenize();
+    cleanTokens(tokens);
+
+    double best = 0;
+    double bestTeardown = 0;
+    size_t numItems = 0;
+    size_t allocations = 0;
+    size_t arenaBytes = 0;
+    for (int i = 0; i < repetitions; i++) {
+        // the parser announces every file it parses
+        std::stringstream log;
+        LogCapture capture(log);
+
+        auto allocationsBefore = numAllocations.load();
+        auto start = std::chrono::steady_clock::now();
+        auto cache = std::make_unique<ParsingCache>();
+        auto parser = std::make_unique<Parser>(tokens, path, "", *cache);
+        auto program = parser->parse();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        allocations = numAllocations.load() - allocationsBefore;
+
+        if (parser->hasErrors()) {
+            std::cerr << "the generated source has syntax errors\n";
+            return 1;
+        }
+        numItems = program->items.size();
+        arenaBytes = getAstArena().getReservedBytes();
+
+        start = std::chrono::steady_clock::now();
+        program.reset();
+        parser.reset();
+        cache.reset();
+        getAstArena().reset();
+        auto teardown = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (i == 0 || elapsed < best) best = elapsed;
+        if (i == 0 || teardown < bestTeardown) bestTeardown = teardown;
+    }
+    std::filesystem::remove(path);
+
+    std::cout << fileSize / (1024.0 * 1024.0) << " MB, " << tokens.size() << " tokens, " << numItems
+              << " functions\n";
+    std::cout << "best of " << repetitions << ": " << best * 1000 << " ms, " << tokens.size() / best / 1e6
+              << " M tokens/s\n";
+    std::cout << allocations << " allocations per parse, " << arenaBytes / (1024.0 * 1024.0)
+              << " MB of AST arena, freeing the AST takes " << bestTeardown * 1000 << " ms\n";
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << "peak RSS: " << usage.ru_maxrss / 1024.0 << " MB\n";
+}
@@ -0,0 +1,67 @@
+#include "R-Sharp/frontend/Tokenizer.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+/*
+Tokenizes a generated R-Sharp file of a few megabytes and reports the throughput.
+
+usage: tokenizer_benchmark [size in MB] [repetitions]
+*/
+
+std::string generateSource(size_t size) {
+    std::mt19937 rng(1);
+    std::string source;
+    source.reserve(size + 1024);
+
+    for (size_t f = 0; source.size() < size; f++) {
+        source += "// function number " + std::to_string(f) + "\n";
+        source += "function_" + std::to_string(f) + "(first_parameter: i64, second_parameter: i64): i64 {\n";
+        source += "    /* a block comment\n       over two lines */\n";
+        for (int s = 0; s < 20; s++) {
+            auto number = std::to_string(rng() % 100000);
+            switch (rng() % 5) {
+                case 0: source += "    local_variable_" + std::to_string(s) + ": i64 = " + number + ";\n"; break;
+                case 1: source += "    if (first_parameter <= " + number + ") { return second_parameter; }\n"; break;
+                case 2: source += "    first_parameter = first_parameter * " + number + " + second_parameter;\n"; break;
+                case 3: source += "    while (second_parameter != 0) { second_parameter = second_parameter - 1; }\n"; break;
+                case 4: source += "    text: i8[] = \"some string literal\\n\";\t\t// trailing comment\n"; break;
+            }
+        }
+        source += "    return first_parameter;\n}\n\n";
+    }
+    return source;
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 4;
+    int repetitions = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    auto path = std::filesystem::temp_directory_path() / "tokenizer_benchmark.rs";
+    {
+        std::ofstream file(path);
+        file << generateSource(megabytes * 1024 * 1024);
+    }
+    auto fileSize = std::filesystem::file_size(path);
+
+    double best = 0;
+    size_t numTokens = 0;
+    for (int i = 0; i < repetitions; i++) {
+        auto start = std::chrono::steady_clock::now();
+        Tokenizer tokenizer(path);
+        auto tokens = tokenizer.tokenize();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        numTokens = tokens.size();
+        if (i == 0 || elapsed < best) best = elapsed;
+    }
+    std::filesystem::remove(path);
+
+    std::cout << fileSize / (1024.0 * 1024.0) << " MB, " << numTokens << " tokens\n";
+    std::cout << "best of " << repetitions << ": " << best * 1000 << " ms, " << fileSize / (1024.0 * 1024.0) / best
+              << " MB/s\n";
+}
@@ -0,0 +1,102 @@
+#include "GeneratedSource.hpp"
+#include "R-Sharp/ast/AstNodes.hpp"
+#include "R-Sharp/ast/AstPrinter.hpp"
+#include "R-Sharp/ast/SemanticValidator.hpp"
+#include "R-Sharp/backend/AArch64CodeGenerator.hpp"
+#include "R-Sharp/backend/CCodeGenerator.hpp"
+#include "R-Sharp/backend/NASMCodeGenerator.hpp"
+#include "R-Sharp/backend/RSIGenerator.hpp"
+#include "R-Sharp/frontend/Parser.hpp"
+#include "R-Sharp/frontend/ParsingCache.hpp"
+#include "R-Sharp/frontend/Tokenizer.hpp"
+#include "R-Sharp/frontend/Utils.hpp"
+#include "R-Sharp/Logging.hpp"
+#include "R-Sharp/Utils/AllocationCounter.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+Runs every AST visitor of the compiler pipeline over a generated R-Sharp file
+of a few megabytes and reports the time and heap allocations of each pass.
+Every pass gets a freshly parsed and validated AST, only the pass itself is timed.
+
+usage: visitor_benchmark [size in MB] [repetitions]
+*/
+
+struct Pass {
+    std::string name;
+    // whether the pass runs on the validated AST
+    bool needsValidation;
+    std::function<void(std::shared_ptr<AstProgram> const&, std::string const&)> run;
+};
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 4;
+    int repetitions = argc > 2 ? std::stoi(argv[2]) : 3;
+
+    auto path = std::filesystem::temp_directory_path() / "visitor_benchmark.rs";
+    {
+        std::ofstream file(path);
+        file << generateSource(megabytes * 1024 * 1024);
+    }
+
+    Tokenizer tokenizer(path);
+    auto tokens = tokenizer.tokenize();
+    cleanTokens(tokens);
+
+    std::vector<Pass> passes = {
+        {"AstPrinter", false, [](auto const& ast, auto const&) { AstPrinter(ast).print(); }},
+        {"SemanticValidator", false,
+         [](auto const& ast, auto const& filename) {
+             SemanticValidator validator(ast, filename);
+             validator.validate();
+             if (validator.hasErrors()) Fatal("the generated source has semantic errors");
+         }},
+        {"CCodeGenerator", true, [](auto const& ast, auto const&) { CCodeGenerator(ast).generate(); }},
+        {"NASMCodeGenerator", true, [](auto const& ast, auto const&) { NASMCodeGenerator(ast).generate(); }},
+        {"AArch64CodeGenerator", true, [](auto const& ast, auto const&) { AArch64CodeGenerator(ast).generate(); }},
+        {"RSIGenerator", true, [](auto const& ast, auto const&) { RSIGenerator(ast).generate(); }},
+    };
+
+    std::cout << std::filesystem::file_size(path) / (1024.0 * 1024.0) << " MB, " << tokens.size() << " tokens\n";
+    for (auto const& pass : passes) {
+        double best = 0;
+        size_t allocations = 0;
+        for (int i = 0; i < repetitions; i++) {
+            // the passes print everything they do
+            std::stringstream log;
+            LogCapture capture(log);
+
+            ParsingCache cache;
+            Parser parser(tokens, path, "", cache);
+            auto ast = parser.parse();
+            if (parser.hasErrors()) {
+                std::cerr << "the generated source has syntax errors\n";
+                return 1;
+            }
+            if (pass.needsValidation) {
+                SemanticValidator validator(ast, path);
+                validator.validate();
+            }
+
+            auto allocationsBefore = numAllocations.load();
+            auto start = std::chrono::steady_clock::now();
+            pass.run(ast, path);
+            auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            allocations = numAllocations.load() - allocationsBefore;
+
+            if (i == 0 || elapsed < best) best = elapsed;
+        }
+        std::cout << std::left << std::setw(22) << pass.name << std::right << std::setw(10) << best * 1000
+                  << " ms " << std::setw(10) << allocations << " allocations\n";
+    }
+    std::filesystem::remove(path);
+}
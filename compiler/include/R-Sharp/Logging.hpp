@@ -3,19 +3,50 @@
 #include <iostream>
 #include <list>
 #include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
 
 #include "ANSI/ANSI.hpp"
 
 template <typename... Args>
 [[noreturn]] inline void Fatal(Args&&... args);
 
+/*
+Thrown by Fatal() instead of exiting where the process mustn't end right away:
+in the tasks of a ThreadPool, whose wait() rethrows it on the waiting thread,
+and in the compiler driver, which unwinds to main() to still write its reports.
+There it is printed with printFatalError().
+*/
+class FatalError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/*
+How much is printed besides errors, warnings and the output asked for. Quiet
+prints nothing else, Verbose follows the progress of the compilation and Debug
+adds the details of the single passes. Building with RSHARP_STRIP_DEBUG_LOGGING
+compiles the debug output out entirely.
+*/
+enum class LogLevel {
+    Quiet,
+    Verbose,
+    Debug,
+};
+
 namespace Internals {
+inline LogLevel logLevel = LogLevel::Quiet;
+
 template <typename... Args>
 void printToStream(std::ostream& stream, Args&&... args) {
     (stream << ... << args);
 }
 
-inline std::list<const char*> contextPath = {};
+inline thread_local std::list<const char*> contextPath = {};
+// where everything but fatal errors is printed to, see LogCapture
+inline thread_local std::ostream* outputStream = &std::cout;
 
 inline const std::string getContext() {
     std::string context = "";
@@ -39,12 +70,16 @@ private:
     const char* name;
 };
 
-inline int errorCount = 0;
+// makes Fatal() throw a FatalError on this thread
+inline thread_local bool fatalErrorsThrow = false;
+
+// counted from every thread
+inline std::atomic<int> errorCount = 0;
 inline int errorLimit = -1;
 
 inline void registerError() {
-    errorCount++;
-    if (errorLimit > 0 && errorCount > errorLimit) {
+    int count = ++errorCount;
+    if (errorLimit > 0 && count > errorLimit) {
         Fatal("Too many errors");
     }
 }
@@ -53,33 +88,82 @@ inline void registerError() {
 
 template <typename... Args>
 [[noreturn]] inline void Fatal(Args&&... args) {
+    std::stringstream message;
     Internals::printToStream(
-        std::cout, ANSI::set4BitColor(ANSI::Red), "[ERROR]", Internals::getContext(), ": ", ANSI::reset(), args..., '\n'
+        message, ANSI::set4BitColor(ANSI::Red), "[ERROR]", Internals::getContext(), ": ", ANSI::reset(), args..., '\n'
     );
+    if (Internals::fatalErrorsThrow) throw FatalError(message.str());
+    std::cout << message.str();
     exit(1);
 }
+inline void printFatalError(FatalError const& error) {
+    std::cout << error.what();
+}
 template <typename... Args>
 inline void Error(Args&&... args) {
     Internals::registerError();
     Internals::printToStream(
-        std::cout, ANSI::set4BitColor(ANSI::Red), "[ERROR]", Internals::getContext(), ": ", ANSI::reset(), args..., '\n'
+        *Internals::outputStream,
+        ANSI::set4BitColor(ANSI::Red),
+        "[ERROR]",
+        Internals::getContext(),
+        ": ",
+        ANSI::reset(),
+        args...,
+        '\n'
     );
 }
 template <typename... Args>
 inline void Warning(Args&&... args) {
     Internals::printToStream(
-        std::cout, ANSI::set4BitColor(ANSI::Yellow), "[WARNING]", Internals::getContext(), ": ", ANSI::reset(), args..., '\n'
+        *Internals::outputStream,
+        ANSI::set4BitColor(ANSI::Yellow),
+        "[WARNING]",
+        Internals::getContext(),
+        ": ",
+        ANSI::reset(),
+        args...,
+        '\n'
     );
 }
 template <typename... Args>
 inline void Log(Args&&... args) {
     Internals::printToStream(
-        std::cout, ANSI::set4BitColor(ANSI::BrightBlue), "[LOG]", Internals::getContext(), ": ", ANSI::reset(), args..., '\n'
+        *Internals::outputStream,
+        ANSI::set4BitColor(ANSI::BrightBlue),
+        "[LOG]",
+        Internals::getContext(),
+        ": ",
+        ANSI::reset(),
+        args...,
+        '\n'
     );
 }
 template <typename... Args>
 inline void Print(Args&&... args) {
-    Internals::printToStream(std::cout, args..., '\n');
+    Internals::printToStream(*Internals::outputStream, args..., '\n');
+}
+
+inline void setLogLevel(LogLevel level) {
+    Internals::logLevel = level;
+}
+inline bool isLogLevelEnabled(LogLevel level) {
+#ifdef RSHARP_STRIP_DEBUG_LOGGING
+    if (level == LogLevel::Debug) return false;
+#endif
+    return level <= Internals::logLevel;
+}
+// prints like Print, but only from LogLevel::Verbose on
+template <typename... Args>
+inline void Verbose(Args&&... args) {
+    if (isLogLevelEnabled(LogLevel::Verbose)) Print(args...);
+}
+// prints like Print, but only at LogLevel::Debug
+template <typename... Args>
+inline void Debug(Args&&... args) {
+#ifndef RSHARP_STRIP_DEBUG_LOGGING
+    if (isLogLevelEnabled(LogLevel::Debug)) Print(args...);
+#endif
 }
 
 inline void setErrorLimit(int limit) {
@@ -91,3 +175,21 @@ inline void resetErrorCount() {
 inline int getErrorCount() {
     return Internals::errorCount;
 }
+
+/*
+Captures everything the current thread prints, except fatal errors, into `stream`
+while alive. Work running concurrently can so be printed in a fixed order later.
+*/
+class LogCapture {
+public:
+    LogCapture(std::ostream& stream): previous(std::exchange(Internals::outputStream, &stream)) {}
+    ~LogCapture() {
+        Internals::outputStream = previous;
+    }
+
+    LogCapture(LogCapture const&) = delete;
+    LogCapture& operator=(LogCapture const&) = delete;
+
+private:
+    std::ostream* previous;
+};
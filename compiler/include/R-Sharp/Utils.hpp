@@ -3,4 +3,5 @@
 
 #include "R-Sharp/frontend/Token.hpp"
 
-void printErrorToken(Token token, std::string const& source);
+// prints the line of the token and up to 3 lines above it, with the token highlighted
+void printErrorToken(Token const& token);
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/*
+The number of heap allocations made through the global operator new since the
+start of the program. The compiler replaces operator new to count them, see
+AllocationCounter.cpp.
+*/
+extern std::atomic<size_t> numAllocations;
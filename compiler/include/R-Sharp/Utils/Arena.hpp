@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+A bump allocator for objects that live until the end of the compilation.
+
+Memory is handed out from large blocks and only given back all at once when the
+arena is destroyed. Every thread bumps its own cursor through its own block, so
+allocating only takes the lock when a thread needs a new block.
+*/
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 256 * 1024) : blockSize(blockSize) {}
+
+    Arena(Arena const&) = delete;
+    Arena& operator=(Arena const&) = delete;
+
+    void* allocate(size_t size, size_t alignment) {
+        auto& cursor = currentCursor;
+        if (cursor.arena == id.load(std::memory_order_relaxed)) {
+            auto start = alignUp(cursor.next, alignment);
+            if (start + size <= cursor.end) {
+                cursor.next = start + size;
+                return reinterpret_cast<void*>(start);
+            }
+        }
+        return allocateSlow(size, alignment);
+    }
+
+    /*
+    Releases everything allocated so far at once. None of the objects allocated
+    from the arena may be used afterwards. Blocks of the regular size are kept
+    for the next allocations.
+    */
+    void reset() {
+        std::lock_guard lock(mutex);
+        // the cursors of all threads point into the old blocks, a new id invalidates them
+        id = nextId++;
+        for (auto& block : blocks) {
+            if (block.size == blockSize) spareBlocks.push_back(std::move(block.memory));
+        }
+        blocks.clear();
+    }
+
+    // the memory in use by the arena's blocks
+    size_t getReservedBytes() {
+        std::lock_guard lock(mutex);
+        size_t bytes = spareBlocks.size() * blockSize;
+        for (auto const& block : blocks)
+            bytes += block.size;
+        return bytes;
+    }
+
+private:
+    // zero initialized for every thread, no arena has the id 0
+    struct Cursor {
+        // the id of the arena the block belongs to, ids aren't reused like addresses
+        uint64_t arena;
+        uintptr_t next;
+        uintptr_t end;
+    };
+
+    static uintptr_t alignUp(uintptr_t address, size_t alignment) {
+        return (address + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    }
+
+    void* allocateSlow(size_t size, size_t alignment) {
+        // large objects get a block of their own and don't waste the rest of the current one
+        if (size + alignment > blockSize / 4) {
+            return reinterpret_cast<void*>(alignUp(newBlock(size + alignment), alignment));
+        }
+
+        auto block = newBlock(blockSize);
+        currentCursor = Cursor{.arena = id.load(std::memory_order_relaxed), .next = block, .end = block + blockSize};
+        return allocate(size, alignment);
+    }
+
+    uintptr_t newBlock(size_t size) {
+        std::lock_guard lock(mutex);
+        if (size == blockSize && !spareBlocks.empty()) {
+            blocks.push_back(Block{.memory = std::move(spareBlocks.back()), .size = size});
+            spareBlocks.pop_back();
+        }
+        else {
+            // not value initialized, the memory is written by whoever allocates it
+            blocks.push_back(Block{.memory = std::unique_ptr<std::byte[]>(new std::byte[size]), .size = size});
+        }
+        return reinterpret_cast<uintptr_t>(blocks.back().memory.get());
+    }
+
+    struct Block {
+        std::unique_ptr<std::byte[]> memory;
+        size_t size;
+    };
+
+    static inline std::atomic<uint64_t> nextId = 1;
+    static inline thread_local Cursor currentCursor;
+
+    std::atomic<uint64_t> id = nextId++;
+    size_t const blockSize;
+
+    std::mutex mutex;
+    std::vector<Block> blocks;
+    std::vector<std::unique_ptr<std::byte[]>> spareBlocks;
+};
+
+/*
+Standard allocator handing out memory from an Arena. Deallocating does
+nothing, the memory is released together with the arena.
+*/
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena& arena) : arena(&arena) {}
+    template <typename U>
+    ArenaAllocator(ArenaAllocator<U> const& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(ArenaAllocator<U> const& other) const {
+        return arena == other.arena;
+    }
+    template <typename U>
+    bool operator!=(ArenaAllocator<U> const& other) const {
+        return arena != other.arena;
+    }
+
+private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    Arena* arena;
+};
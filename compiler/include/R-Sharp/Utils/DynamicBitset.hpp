@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*
+A fixed size set of small integers stored one bit per element.
+
+All set operations work on whole 64-bit words, so the loops are
+simple enough for the compiler to vectorize.
+*/
+class DynamicBitset {
+public:
+    using Word = uint64_t;
+    static constexpr size_t bitsPerWord = 64;
+
+    DynamicBitset() = default;
+    explicit DynamicBitset(size_t size): numBits(size), words((size + bitsPerWord - 1) / bitsPerWord, 0) {}
+
+    size_t size() const {
+        return numBits;
+    }
+
+    void set(size_t i) {
+        words[i / bitsPerWord] |= Word(1) << (i % bitsPerWord);
+    }
+    void reset(size_t i) {
+        words[i / bitsPerWord] &= ~(Word(1) << (i % bitsPerWord));
+    }
+    bool test(size_t i) const {
+        return (words[i / bitsPerWord] >> (i % bitsPerWord)) & 1;
+    }
+
+    size_t count() const {
+        size_t result = 0;
+        for (auto word : words)
+            result += __builtin_popcountll(word);
+        return result;
+    }
+    bool none() const {
+        for (auto word : words)
+            if (word) return false;
+        return true;
+    }
+
+    // union
+    DynamicBitset& operator|=(DynamicBitset const& other) {
+        for (size_t i = 0; i < words.size(); i++)
+            words[i] |= other.words[i];
+        return *this;
+    }
+    // difference
+    DynamicBitset& operator-=(DynamicBitset const& other) {
+        for (size_t i = 0; i < words.size(); i++)
+            words[i] &= ~other.words[i];
+        return *this;
+    }
+
+    bool operator==(DynamicBitset const& other) const {
+        return numBits == other.numBits && words == other.words;
+    }
+    bool operator!=(DynamicBitset const& other) const {
+        return !(*this == other);
+    }
+
+    // call `func` with the index of every set bit in ascending order
+    template <typename Func>
+    void forEach(Func&& func) const {
+        for (size_t w = 0; w < words.size(); w++) {
+            Word word = words[w];
+            while (word) {
+                func(w * bitsPerWord + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+private:
+    size_t numBits = 0;
+    std::vector<Word> words;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+// the contents of a JSON string literal for `text`, without the quotes
+inline std::string escapeJson(std::string const& text) {
+    std::stringstream stream;
+    for (char c : text) {
+        if (c == '"' || c == '\\') stream << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+        else stream << c;
+    }
+    return stream.str();
+}
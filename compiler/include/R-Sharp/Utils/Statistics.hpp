@@ -0,0 +1,77 @@
+#pragma once
+
+#include "R-Sharp/Utils/Trace.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+Collects the time, heap allocations and peak memory of the phases of a
+compilation, for --time-passes and --stats.
+
+Phases are measured by keeping a Statistics::Phase alive while they run, they
+may nest. Phases are only started and ended by the main thread, work a phase
+hands to a thread pool is measured as a whole. Nothing is recorded unless the
+statistics are enabled. Every phase is an event of the Trace as well.
+*/
+class Statistics {
+public:
+    struct PhaseData {
+        std::string name;
+        // the number of phases this one runs in
+        size_t depth = 0;
+        std::chrono::steady_clock::duration time{};
+        size_t allocations = 0;
+        // peak resident set size of the process at the end of the phase
+        size_t peakRssKiB = 0;
+        // the number of RSI instructions before and after an RSI pass
+        std::optional<size_t> instructionsBefore{};
+        std::optional<size_t> instructionsAfter{};
+    };
+
+    class Phase {
+    public:
+        Phase(Phase const&) = delete;
+        Phase& operator=(Phase const&) = delete;
+        ~Phase();
+
+        void setInstructionCounts(size_t before, size_t after);
+
+    private:
+        friend class Statistics;
+        Phase(Statistics* statistics, std::string name);
+
+        // null if the statistics are disabled
+        Statistics* statistics;
+        Trace::Event traceEvent;
+        size_t index = 0;
+        std::chrono::steady_clock::time_point start;
+        size_t allocationsBefore = 0;
+    };
+
+    static Statistics& get();
+
+    void enable();
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    [[nodiscard]] Phase phase(std::string name);
+
+    std::vector<PhaseData> const& getPhases() const {
+        return phases;
+    }
+
+    void printTable(std::ostream& stream) const;
+    void printJson(std::ostream& stream) const;
+
+private:
+    bool enabled = false;
+    std::chrono::steady_clock::time_point start;
+    size_t depth = 0;
+    std::vector<PhaseData> phases;
+};
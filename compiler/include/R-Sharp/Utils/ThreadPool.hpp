@@ -0,0 +1,199 @@
+#pragma once
+
+#include "R-Sharp/Logging.hpp"
+#include "R-Sharp/Utils/ScopeGuard.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+A work stealing thread pool.
+
+Every worker owns a queue. Tasks submitted from a worker go to the back of its
+own queue and are taken from there again (newest first), idle workers steal from
+the front of the other queues. Tasks submitted from outside the pool are spread
+over the queues round robin.
+
+A pool of `numThreads` runs `numThreads - 1` workers, the thread calling wait()
+works on the queued tasks as well. A pool of one thread therefore runs everything
+on the calling thread in submission order.
+
+Tasks must not end the process, so Fatal() throws inside of them. The first
+exception a task throws is rethrown by wait() once all tasks are done, the tasks
+that haven't started by then are skipped. parallelFor() on a pool of one thread
+lets it pass through directly.
+*/
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t numThreads) {
+        if (numThreads == 0) numThreads = 1;
+        for (size_t i = 0; i < numThreads; i++)
+            queues.push_back(std::make_unique<Queue>());
+        for (size_t i = 1; i < numThreads; i++)
+            workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    size_t size() const {
+        return queues.size();
+    }
+
+    void submit(Task task) {
+        size_t queue;
+        {
+            std::lock_guard lock(mutex);
+            queue = currentPool == this ? currentQueue : nextQueue++ % queues.size();
+            queued++;
+            unfinished++;
+        }
+        {
+            std::lock_guard lock(queues[queue]->mutex);
+            queues[queue]->tasks.push_back(std::move(task));
+        }
+        wakeUp.notify_one();
+    }
+
+    // run tasks until every submitted task is finished, must not be called from inside a task
+    // rethrows the first exception of a task
+    void wait() {
+        auto previousPool = std::exchange(currentPool, this);
+        auto previousQueue = std::exchange(currentQueue, 0);
+
+        while (true) {
+            Task task;
+            if (tryTake(0, task)) {
+                runTask(task);
+                continue;
+            }
+            std::unique_lock lock(mutex);
+            if (unfinished == 0) break;
+            if (queued == 0) finished.wait(lock, [this]() { return unfinished == 0 || queued != 0; });
+        }
+
+        currentPool = previousPool;
+        currentQueue = previousQueue;
+
+        std::exception_ptr failure;
+        {
+            std::lock_guard lock(mutex);
+            failure = std::exchange(error, nullptr);
+        }
+        if (failure) std::rethrow_exception(failure);
+    }
+
+    // call `func(i)` for every i in [0, n) and wait for all of them
+    template <typename Func>
+    void parallelFor(size_t n, Func&& func) {
+        if (size() == 1) {
+            // like in a task, Fatal() throws, but right through to the caller
+            auto previousFatalErrorsThrow = std::exchange(Internals::fatalErrorsThrow, true);
+            ScopeGuard restore([&]() { Internals::fatalErrorsThrow = previousFatalErrorsThrow; });
+            for (size_t i = 0; i < n; i++)
+                func(i);
+            return;
+        }
+        for (size_t i = 0; i < n; i++)
+            submit([&func, i]() { func(i); });
+        wait();
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool tryTake(size_t own, Task& task) {
+        for (size_t offset = 0; offset < queues.size(); offset++) {
+            auto& queue = *queues[(own + offset) % queues.size()];
+            std::lock_guard lock(queue.mutex);
+            if (queue.tasks.empty()) continue;
+            if (offset == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            std::lock_guard countLock(mutex);
+            queued--;
+            return true;
+        }
+        return false;
+    }
+
+    void runTask(Task& task) {
+        bool hasFailed;
+        {
+            std::lock_guard lock(mutex);
+            hasFailed = error != nullptr;
+        }
+        if (!hasFailed) {
+            auto previousFatalErrorsThrow = std::exchange(Internals::fatalErrorsThrow, true);
+            try {
+                task();
+            }
+            catch (...) {
+                std::lock_guard lock(mutex);
+                if (!error) error = std::current_exception();
+            }
+            Internals::fatalErrorsThrow = previousFatalErrorsThrow;
+        }
+
+        std::lock_guard lock(mutex);
+        if (--unfinished == 0) finished.notify_all();
+    }
+
+    void workerLoop(size_t own) {
+        currentPool = this;
+        currentQueue = own;
+        while (true) {
+            Task task;
+            if (tryTake(own, task)) {
+                runTask(task);
+                continue;
+            }
+            std::unique_lock lock(mutex);
+            wakeUp.wait(lock, [this]() { return stopping || queued != 0; });
+            if (stopping) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable finished;
+    size_t queued = 0;
+    size_t unfinished = 0;
+    size_t nextQueue = 0;
+    bool stopping = false;
+    // the first exception of a task since the last wait()
+    std::exception_ptr error;
+
+    static inline thread_local ThreadPool* currentPool = nullptr;
+    static inline thread_local size_t currentQueue = 0;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+Records what the compiler does when on which thread, for --trace. The result
+is written in the Chrome trace event format, which chrome://tracing and
+Perfetto display with one lane per thread.
+
+An event lasts as long as the Trace::Event object returned by event(). Events
+may be recorded from any thread, every thread appends to its own list. Nothing
+is recorded, and no strings are copied, unless tracing is enabled.
+*/
+class Trace {
+public:
+    class Event {
+    public:
+        Event(Event const&) = delete;
+        Event& operator=(Event const&) = delete;
+        ~Event();
+
+    private:
+        friend class Trace;
+        Event(Trace* trace, std::string_view name, std::string_view detail);
+
+        // null if tracing is disabled
+        Trace* trace;
+        std::string name;
+        std::string detail;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    static Trace& get();
+
+    // must be called before other threads record events, the calling thread is the main thread
+    void enable();
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    // `detail` is shown along with the name, e.g. the file an event is about
+    [[nodiscard]] Event event(std::string_view name, std::string_view detail = {});
+
+    // false if the file can't be written, must not be called while events are recorded
+    bool write(std::string const& filename) const;
+
+private:
+    struct Record {
+        std::string name;
+        std::string detail;
+        // microseconds since tracing was enabled
+        double start;
+        double duration;
+    };
+    struct Thread {
+        size_t id;
+        std::vector<Record> records;
+    };
+
+    Thread& getThread();
+
+    bool enabled = false;
+    std::chrono::steady_clock::time_point start;
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Thread>> threads;
+};
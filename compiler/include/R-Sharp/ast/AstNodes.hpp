@@ -4,18 +4,18 @@
 #include "R-Sharp/ast/AstNodesFWD.hpp"
 #include "R-Sharp/ast/AstVisitor.hpp"
 #include "R-Sharp/backend/RSI_FWD.hpp"
+#include "R-Sharp/Utils/Arena.hpp"
 
 #include <vector>
 #include <string>
 #include <memory>
 #include <variant>
 #include <optional>
+#include <utility>
 
-template <typename... Args>
-std::vector<std::shared_ptr<AstNode>> combineChildren(Args... args) {
-    std::vector<std::shared_ptr<AstNode>> children;
-    (children.push_back(std::dynamic_pointer_cast<AstNode>(args)), ...);
-    return children;
+template <typename... Children>
+void forEachNonNull(ChildCallback callback, Children const&... children) {
+    ((children ? callback(children.get()) : void()), ...);
 }
 
 // Helper macros to make it easier to define AST nodes
@@ -37,19 +37,18 @@ std::vector<std::shared_ptr<AstNode>> combineChildren(Args... args) {
 
 #define SINGLE_CHILD(TYPE, VARIABLE_NAME) std::shared_ptr<TYPE> VARIABLE_NAME;
 
-#define GET_SINGLE_CHILDREN(...)                                         \
-    std::vector<std::shared_ptr<AstNode>> getChildren() const override { \
-        return combineChildren(semanticType, __VA_ARGS__);               \
+#define GET_SINGLE_CHILDREN(...)                               \
+    void forEachChild(ChildCallback callback) const override { \
+        forEachNonNull(callback, semanticType, __VA_ARGS__);   \
     }
 
 #define MULTI_CHILD(TYPE, VARIABLE_NAME) std::vector<std::shared_ptr<TYPE>> VARIABLE_NAME;
 
-#define GET_MULTI_CHILD(VARIABLE_NAME)                                                                                \
-    std::vector<std::shared_ptr<AstNode>> getChildren() const override {                                              \
-        std::vector<std::shared_ptr<AstNode>> internal_children = {std::dynamic_pointer_cast<AstNode>(semanticType)}; \
-        for (auto& child : VARIABLE_NAME)                                                                             \
-            internal_children.push_back(std::dynamic_pointer_cast<AstNode>(child));                                   \
-        return internal_children;                                                                                     \
+#define GET_MULTI_CHILD(VARIABLE_NAME)                         \
+    void forEachChild(ChildCallback callback) const override { \
+        forEachNonNull(callback, semanticType);                \
+        for (auto const& child : VARIABLE_NAME)                \
+            forEachNonNull(callback, child);                   \
     }
 
 
@@ -68,6 +67,21 @@ std::vector<std::shared_ptr<AstNode>> combineChildren(Args... args) {
 #define DESTRUCTOR(NAME) virtual ~NAME() = default;
 
 
+/*
+AST nodes and their semantic data are allocated together with their reference
+count in one arena. Releasing a node only runs its destructor, the memory is
+given back all at once when the compiler exits.
+*/
+inline Arena& getAstArena() {
+    static Arena arena;
+    return arena;
+}
+
+template <typename T, typename... Args>
+std::shared_ptr<T> makeNode(Args&&... args) {
+    return std::allocate_shared<T>(ArenaAllocator<T>(getAstArena()), std::forward<Args>(args)...);
+}
+
 struct SemanticVariableData {
     bool isGlobal = false;
     bool isDefined = false;
@@ -143,10 +157,15 @@ struct AstErrorNode : public virtual AstNode {
 struct AstProgramItem : public virtual AstNode {
     DESTRUCTOR(AstProgramItem)
 };
+struct InternedType;
+
 struct AstType : public virtual AstNode {
     DESTRUCTOR(AstType)
 
     virtual bool isErrorType() = 0;
+
+    // set by the TypeContext, has to be reset when the type is changed afterwards
+    mutable InternedType const* internedType = nullptr;
 };
 
 // ----------------------------------| Program Items |---------------------------------- //
@@ -565,12 +584,12 @@ struct AstArrayType : public AstType, public std::enable_shared_from_this<AstArr
         return subtype->isErrorType() || (size.has_value() && size.value()->getType() != AstNodeType::AstInteger);
     }
 
-    std::vector<std::shared_ptr<AstNode>> getChildren() const override {
+    void forEachChild(ChildCallback callback) const override {
         if (size.has_value()) {
-            return combineChildren(subtype, size.value());
+            forEachNonNull(callback, subtype, size.value());
         }
         else
-            return combineChildren(subtype);
+            forEachNonNull(callback, subtype);
     }
 
     std::shared_ptr<AstType> subtype;
@@ -107,13 +107,36 @@ struct AstArrayType;
 struct AstPrimitiveType;
 struct AstTags;
 
+struct AstNode;
+
+/*
+A non-owning reference to the function called with every child of a node.
+Unlike std::function it never allocates, the referenced function has to outlive
+the call to forEachChild().
+*/
+class ChildCallback {
+public:
+    template <typename Function>
+    ChildCallback(Function const& function)
+        : function(&function), invoke([](void const* function, AstNode* child) {
+              (*static_cast<Function const*>(function))(child);
+          }) {}
+
+    void operator()(AstNode* child) const {
+        invoke(function, child);
+    }
+
+private:
+    void const* function;
+    void (*invoke)(void const*, AstNode*);
+};
+
 struct AstNode {
     virtual ~AstNode() = default;
     AstNode() = default;
 
-    virtual std::vector<std::shared_ptr<AstNode>> getChildren() const {
-        return {};
-    };
+    // calls the callback with every child that isn't null, in order
+    virtual void forEachChild(ChildCallback /*callback*/) const {}
     virtual AstNodeType getType() const = 0;
     virtual std::string toString() const = 0;
     virtual void accept(AstVisitor* visitor) = 0;
@@ -24,13 +24,15 @@ public:
         Print(oldPrefix, nodeConnection, node->toString());
 
 
-        auto const& children = node->getChildren();
-        for (int i = 0; i < children.size(); i++) {
-            if (!children.at(i)) continue;
+        size_t numChildren = 0;
+        node->forEachChild([&](AstNode*) { numChildren++; });
+
+        size_t i = 0;
+        node->forEachChild([&](AstNode* child) {
             prefix = oldPrefix + (isThisTail ? "    " : "│   ");
-            isTail = i == children.size() - 1;
-            children.at(i)->accept(this);
-        }
+            isTail = ++i == numChildren;
+            child->accept(this);
+        });
     }
 
 private:
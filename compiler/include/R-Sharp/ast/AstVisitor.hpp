@@ -4,19 +4,15 @@
 
 #include <memory>
 
-#define VISITOR_FN(NAME)                                 \
-    virtual void visit(std::shared_ptr<NAME> node) {     \
-        visit(std::dynamic_pointer_cast<AstNode>(node)); \
-    }
+// by default every node is visited like a generic AstNode
+#define VISITOR_FN(NAME) virtual void visit(std::shared_ptr<NAME> node)
 
 class AstVisitor {
 public:
     virtual ~AstVisitor() = default;
 
     virtual void visit(std::shared_ptr<AstNode> node) {
-        for (auto& child : node->getChildren()) {
-            if (child) child->accept(this);
-        }
+        visitChildren(node.get());
     }
 
     VISITOR_FN(AstProgram);
@@ -64,6 +60,10 @@ public:
     VISITOR_FN(AstTags);
 
 protected:
+    void visitChildren(AstNode const* node) {
+        node->forEachChild([this](AstNode* child) { child->accept(this); });
+    }
+
     // this will keep the nodes alive
     std::shared_ptr<AstProgram> root;
 };
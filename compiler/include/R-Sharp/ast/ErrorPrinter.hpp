@@ -7,8 +7,7 @@
 
 class ErrorPrinter : public AstVisitor {
 public:
-    ErrorPrinter(std::shared_ptr<AstNode> root, std::string const& filename, std::string const& source)
-        : root(root), filename(filename), source(source) {}
+    ErrorPrinter(std::shared_ptr<AstNode> root, std::string const& filename): root(root), filename(filename) {}
 
     void print() {
         root->accept(this);
@@ -16,19 +15,18 @@ public:
 
     void visit(std::shared_ptr<AstErrorStatement> node) override {
         Error(node->name);
-        printErrorToken(node->token, *(node->token.source));
+        printErrorToken(node->token);
     };
     void visit(std::shared_ptr<AstErrorExpression> node) override {
         Error(node->name);
-        printErrorToken(node->token, *(node->token.source));
+        printErrorToken(node->token);
     };
     void visit(std::shared_ptr<AstErrorProgramItem> node) override {
         Error(node->name);
-        printErrorToken(node->token, *(node->token.source));
+        printErrorToken(node->token);
     };
 
 private:
     std::string filename;
-    std::string source;
     std::shared_ptr<AstNode> root;
 };
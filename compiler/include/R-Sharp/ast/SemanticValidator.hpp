@@ -2,13 +2,16 @@
 
 #include "R-Sharp/ast/AstNodes.hpp"
 #include "R-Sharp/ast/AstVisitor.hpp"
+#include "R-Sharp/ast/SymbolTable.hpp"
 
 #include <vector>
 #include <stack>
+#include <string_view>
+#include <unordered_map>
 
 class SemanticValidator : public AstVisitor {
 public:
-    SemanticValidator(std::shared_ptr<AstNode> root, std::string const& filename, std::string const& source);
+    SemanticValidator(std::shared_ptr<AstNode> root, std::string const& filename);
     void validate();
     bool hasErrors();
 
@@ -55,8 +58,12 @@ private:
     void addVariable(std::shared_ptr<AstVariableDeclaration> var);
     std::shared_ptr<SemanticVariableData> getVariable(std::string const& name);
 
-    bool isFunctionDefined(std::string name) const;
-    std::shared_ptr<SemanticFunctionData> getFunction(std::string name, std::shared_ptr<AstParameterList> params);
+    bool isFunctionDefined(std::string const& name) const;
+    void addFunction(std::shared_ptr<AstFunctionDefinition> function);
+    std::shared_ptr<SemanticFunctionData> getFunction(
+        std::string const& name,
+        std::shared_ptr<AstParameterList> params
+    );
 
     bool requireEquivalentTypes(
         std::shared_ptr<AstNode> expected,
@@ -65,18 +72,37 @@ private:
     );
     void requireType(std::shared_ptr<AstNode> node);
     bool areEquivalentTypes(std::shared_ptr<AstType> expected, std::shared_ptr<AstType> found);
+    bool areEquivalentTypes(InternedType const* expected, InternedType const* found);
     bool areEquivalentTypesInSharedPtr(std::shared_ptr<AstNode> expected, std::shared_ptr<AstNode> found);
 
 private:
     std::shared_ptr<AstNode> root;
     std::string filename;
-    std::string source;
 
     std::vector<std::shared_ptr<AstBlock>> variableContexts;
+    // the variables of variableContexts by name
+    SymbolTable variables;
     bool collapseContexts = false;
 
     std::stack<std::shared_ptr<SemanticLoopData>> loops;
-    std::vector<std::shared_ptr<SemanticFunctionData>> functions;
+
+    // functions are looked up by name and number of parameters, the names view the function definitions
+    struct FunctionSignature {
+        std::string_view name;
+        size_t numParameters;
+
+        bool operator==(FunctionSignature const& other) const {
+            return name == other.name && numParameters == other.numParameters;
+        }
+    };
+    struct FunctionSignatureHash {
+        size_t operator()(FunctionSignature const& signature) const {
+            return std::hash<std::string_view>()(signature.name) * 31 + signature.numParameters;
+        }
+    };
+    std::unordered_map<std::string_view, std::shared_ptr<SemanticFunctionData>> functions;
+    std::unordered_map<FunctionSignature, std::vector<std::shared_ptr<SemanticFunctionData>>, FunctionSignatureHash>
+        functionOverloads;
 
     std::shared_ptr<AstFunctionDefinition> currentFunction;
 
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "R-Sharp/ast/AstNodes.hpp"
+
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+The variables visible at one point of the program, by name.
+
+Every name maps to the stack of its declarations in the open scopes, so looking
+up a variable doesn't depend on how many scopes or variables there are. The
+names are views of the strings held by the variables themselves, nothing is
+copied. Closing a scope only removes the names declared in it.
+*/
+class SymbolTable {
+public:
+    void pushScope();
+    void popScope();
+
+    // declares the variable in the innermost scope, hiding outer ones with the same name
+    void declare(std::shared_ptr<SemanticVariableData> const& variable);
+
+    // the declaration in the innermost scope that has one, nullptr if there is none
+    std::shared_ptr<SemanticVariableData> lookup(std::string_view name) const;
+    // nullptr unless the name is declared in the innermost scope
+    std::shared_ptr<SemanticVariableData> lookupInnermost(std::string_view name) const;
+
+private:
+    struct Binding {
+        size_t scope;
+        std::shared_ptr<SemanticVariableData> variable;
+    };
+
+    std::unordered_map<std::string_view, std::vector<Binding>> bindings;
+    // the names declared in every open scope
+    std::vector<std::vector<std::string_view>> scopes;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "R-Sharp/ast/AstNodes.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_set>
+
+/*
+One distinct type. Every type exists only once in the TypeContext, two AstTypes
+describe the same type exactly if they intern to the same InternedType.
+*/
+struct InternedType {
+    AstNodeType kind;
+    // primitive types only
+    RSharpPrimitiveType primitive = RSharpPrimitiveType::NONE;
+    // pointer and array types only
+    InternedType const* subtype = nullptr;
+
+    // arrays only, false for unsized arrays
+    bool hasSize = false;
+    // the element count of arrays sized by an integer literal
+    std::optional<int64_t> length{};
+
+    // in bytes, computed once when the type is interned. nullopt if the type has no size
+    std::optional<int> size{};
+    // the type or one of its subtypes is the error type or an array of non constant size
+    bool isErrorType = false;
+
+    bool operator==(InternedType const& other) const {
+        return kind == other.kind && primitive == other.primitive && subtype == other.subtype
+            && hasSize == other.hasSize && length == other.length;
+    }
+};
+
+/*
+Interns the types of the compilation. AstTypes remember their interned type,
+so comparing two types only walks them the first time.
+*/
+class TypeContext {
+public:
+    // the context shared by all passes of the compilation
+    static TypeContext& get();
+
+    InternedType const* intern(AstType const& type);
+    // the size of the type in bytes, throws if it has none
+    int getSize(AstType const& type);
+
+private:
+    struct Hash {
+        size_t operator()(InternedType const& type) const;
+    };
+
+    InternedType const* intern(InternedType type);
+
+    std::mutex mutex;
+    std::unordered_set<InternedType, Hash> types;
+};
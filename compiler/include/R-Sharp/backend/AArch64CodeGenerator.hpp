@@ -11,7 +11,7 @@
 
 class AArch64CodeGenerator : public AstVisitor {
 public:
-    AArch64CodeGenerator(std::shared_ptr<AstProgram> root, std::string R_SharpSource);
+    AArch64CodeGenerator(std::shared_ptr<AstProgram> root);
 
     std::string generate();
 
@@ -100,6 +100,4 @@ private:
     int stackPassedValueSize = 0;
     int arrayAccessFinalSize = 0;
     ValueType expectedValueType = ValueType::Value;
-
-    std::string R_SharpSource;
 };
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "R-Sharp/backend/X86Encoder.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+Writes a relocatable x86-64 ELF object, the file "nasm -f elf64" would produce
+for the encoded code, without debug information.
+
+The labels of the code are local symbols unless they are added as globals.
+Every symbol a relocation refers to has to be a label, a variable or an
+extern, otherwise writing fails with an error.
+*/
+class ElfObjectWriter {
+public:
+    // `text` has to be finished and outlive the writer
+    explicit ElfObjectWriter(X86Encoder const& text) : text(text) {}
+
+    // a label of the code that is visible to other objects, an undefined one is treated like an extern
+    void addGlobal(std::string_view label);
+    // a symbol that is defined by another object
+    void addExtern(std::string_view name);
+    // an initialized 8 byte variable in .data
+    void addVariable(std::string_view name, int64_t value);
+    // a zero initialized variable in .bss
+    void addUninitializedVariable(std::string_view name, size_t size);
+
+    // the contents of the object file, nullopt if a symbol is missing
+    std::optional<std::string> write() const;
+
+private:
+    struct Variable {
+        std::string_view name;
+        int64_t value;
+    };
+    struct UninitializedVariable {
+        std::string_view name;
+        size_t size;
+    };
+
+    X86Encoder const& text;
+    std::vector<std::string_view> globals;
+    std::vector<std::string_view> externs;
+    std::vector<Variable> variables;
+    std::vector<UninitializedVariable> uninitializedVariables;
+};
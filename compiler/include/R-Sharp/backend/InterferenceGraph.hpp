@@ -0,0 +1,79 @@
+#pragma once
+
+#include "R-Sharp/backend/RSI_FWD.hpp"
+#include "R-Sharp/Utils/DynamicBitset.hpp"
+
+#include <vector>
+#include <limits>
+#include <optional>
+#include <cstddef>
+
+namespace RSI {
+
+/*
+Undirected graph over the references of a function, indexed by Reference::index.
+
+Edges are stored twice: a triangular bit matrix answers "do a and b interfere"
+in constant time and keeps edges unique, while the adjacency vectors allow
+iterating the neighbours of a vertex without scanning the matrix.
+*/
+class InterferenceGraph {
+public:
+    InterferenceGraph() = default;
+    explicit InterferenceGraph(size_t numVertices);
+
+    size_t size() const {
+        return adjacency.size();
+    }
+
+    // returns false if the edge already existed, self edges are ignored
+    bool addEdge(size_t a, size_t b);
+    bool interferes(size_t a, size_t b) const;
+
+    std::vector<size_t> const& neighbours(size_t vertex) const {
+        return adjacency.at(vertex);
+    }
+    size_t degree(size_t vertex) const {
+        return adjacency.at(vertex).size();
+    }
+
+private:
+    static size_t matrixIndex(size_t a, size_t b);
+
+    DynamicBitset matrix;
+    std::vector<std::vector<size_t>> adjacency;
+};
+
+/*
+Build the interference graph from the results of the liveness analysis.
+
+A definition interferes with everything that is live after it. As no variable
+is live on function entry, this covers every pair of simultaneously live
+references without looking at all pairs at every instruction.
+*/
+InterferenceGraph buildInterferenceGraph(Function const& function);
+
+using Color = size_t;
+
+// vertices that could not be given one of the available colors
+constexpr Color spilledColor = std::numeric_limits<Color>::max();
+
+/*
+Color the graph with the colors [0, numColors) using optimistic Chaitin-Briggs coloring.
+
+Vertices with a value in `precolored` keep that color. A precolored vertex only
+constrains its neighbours if its color is one of the available ones, so e.g.
+vertices that are already on the stack can be passed as spilledColor.
+
+Vertices of low degree are simplified first. When none are left, the vertex with
+the lowest spillCosts / degree is pushed optimistically, and only becomes
+spilledColor if its neighbours use up all colors during select.
+*/
+std::vector<Color> colorInterferenceGraph(
+    InterferenceGraph const& graph,
+    std::vector<std::optional<Color>> const& precolored,
+    std::vector<double> const& spillCosts,
+    size_t numColors
+);
+
+}
@@ -16,7 +16,7 @@ public:
     struct Variable;
     struct LoopInfo;
     struct VariableScope;
-    NASMCodeGenerator(std::shared_ptr<AstProgram> root, std::string R_SharpSource);
+    NASMCodeGenerator(std::shared_ptr<AstProgram> root);
 
     std::string generate();
 
@@ -114,6 +114,4 @@ private:
     int stackPassedValueSize = 0;
     int arrayAccessFinalSize = 0;
     ValueType expectedValueType = ValueType::Value;
-
-    std::string R_SharpSource;
 };
@@ -2,6 +2,7 @@
 
 #include "R-Sharp/backend/RSI_FWD.hpp"
 #include "R-Sharp/ast/AstNodes.hpp"
+#include "R-Sharp/Utils/DynamicBitset.hpp"
 
 #include <cstdint>
 #include <string>
@@ -143,6 +144,8 @@ struct Reference {
     std::string name;
     std::optional<std::shared_ptr<SemanticVariableData>> variable;
     StorageLocation storageLocation;
+    // position in Function::meta.referencesByIndex, assigned by the liveness analysis
+    uint64_t index = 0;
 
     bool operator<(Reference const& other) const {
         return name < other.name;
@@ -194,7 +197,8 @@ struct Instruction {
     Operand op2;
 
     struct Metadata {
-        std::set<std::shared_ptr<Reference>> liveVariablesBefore = {};
+        // indexed by Reference::index
+        DynamicBitset liveVariablesBefore = {};
     } meta;
 };
 
@@ -205,8 +209,12 @@ struct Function {
 
     struct Metadata {
         std::set<std::shared_ptr<Reference>> allReferences = {};
+        std::vector<std::shared_ptr<Reference>> referencesByIndex = {};
         std::set<HWRegister> allRegisters = {};
         uint64_t maxStackUsage = 0;
+        uint64_t coalescedMoves = 0;
+        // names made unique by passes on this function, see RSIGenerator::UniqueNameScope
+        uint64_t uniqueNames = 0;
     } meta;
 };
 
@@ -9,6 +9,7 @@ namespace RSI {
 
 void analyzeLiveVariables(Function& function, Architecture const& architecture);
 void assignRegistersGraphColoring(Function& func, Architecture const& architecture);
+void assignRegistersLinearScan(Function& func, Architecture const& architecture);
 void enumerateRegisters(Function& func, Architecture const& architecture);
 
 void replaceModWithDivMulSub(
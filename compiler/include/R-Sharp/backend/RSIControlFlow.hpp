@@ -0,0 +1,32 @@
+#pragma once
+
+#include "R-Sharp/backend/RSI_FWD.hpp"
+
+#include <vector>
+#include <cstddef>
+
+namespace RSI {
+
+struct BasicBlock {
+    // instructions [begin, end) of the owning function
+    size_t begin = 0;
+    size_t end = 0;
+
+    std::vector<size_t> successors;
+    std::vector<size_t> predecessors;
+};
+
+struct ControlFlowGraph {
+    std::vector<BasicBlock> blocks;
+};
+
+/*
+Split a function into basic blocks.
+
+A block starts at the first instruction, at every DEFINE_LABEL and after every
+JUMP, JUMP_IF_ZERO or RETURN. Jumps are resolved through their label, so the
+whole graph is built in a single pass over the instructions.
+*/
+ControlFlowGraph buildControlFlowGraph(Function const& function);
+
+}
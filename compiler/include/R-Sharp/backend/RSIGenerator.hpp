@@ -10,7 +10,7 @@
 
 class RSIGenerator : public AstVisitor {
 public:
-    RSIGenerator(std::shared_ptr<AstProgram> root, std::string R_SharpSource);
+    RSIGenerator(std::shared_ptr<AstProgram> root);
 
     RSI::TranslationUnit generate();
 
@@ -53,6 +53,23 @@ public:
     static std::shared_ptr<RSI::Reference> getNewReference(std::string const& name = "tmp");
     static std::shared_ptr<RSI::Label> getNewLabel(std::string const& name = "label");
 
+    /*
+    While alive, makeStringUnique numbers the names made on the current thread per
+    function. Passes running on several functions at once so still produce the same
+    names on every run.
+    */
+    class UniqueNameScope {
+    public:
+        explicit UniqueNameScope(RSI::Function& function);
+        ~UniqueNameScope();
+
+        UniqueNameScope(UniqueNameScope const&) = delete;
+        UniqueNameScope& operator=(UniqueNameScope const&) = delete;
+
+    private:
+        RSI::Function* previous;
+    };
+
 private:
     void emit(RSI::Instruction instr) {
         generatedTU.functions.back().instructions.push_back(instr);
@@ -83,6 +100,4 @@ private:
     ValueType expectedValueType = ValueType::Value;
 
     RSI::Operand lastResult;
-
-    std::string R_SharpSource;
 };
\ No newline at end of file
@@ -2,10 +2,13 @@
 
 #include "R-Sharp/backend/RSI_FWD.hpp"
 #include "R-Sharp/backend/Architecture.hpp"
+#include "R-Sharp/Utils/ThreadPool.hpp"
 
+#include <array>
 #include <functional>
 #include <string>
 #include <set>
+#include <vector>
 
 struct RSIPass {
     std::string humanHeader;
@@ -21,6 +24,47 @@ struct RSIPass {
     bool isFunctionWide = false;
     std::function<void(RSI::Function&, Architecture const&)> perFunctionFunction;
 
-    void operator()(RSI::Function& function, OutputArchitecture arch) const;
-    void operator()(std::vector<RSI::Function>& functions, OutputArchitecture arch) const;
-};
\ No newline at end of file
+    // print all functions once the pass is done
+    bool isDumped = false;
+
+    bool appliesTo(RSI::InstructionType type) const;
+};
+
+/*
+Runs a pipeline of RSIPasses over all functions.
+
+Consecutive per-instruction passes that only select instructions by disjoint
+`positiveInstructionTypes` are fused into one sweep: every instruction is
+dispatched through a table indexed by its type to the single pass handling it,
+and instructions a pass inserts continue through the passes behind it in the
+same sweep. The result is identical to running the passes one after another.
+
+Functions are processed concurrently on the given thread pool, their log output
+is printed in function order once a sweep is done. Every sweep is a phase of
+the compilation Statistics, named after its passes.
+*/
+class RSIPassManager {
+public:
+    RSIPassManager(std::vector<RSIPass> passes, OutputArchitecture architecture);
+
+    // throws the FatalError of a function that fails on a thread of `threadPool`
+    void run(std::vector<RSI::Function>& functions, ThreadPool& threadPool);
+
+private:
+    static constexpr uint8_t noPass = 0xff;
+
+    struct Sweep {
+        std::vector<RSIPass> passes;
+        // position in `passes` of the pass handling each instruction type
+        std::array<uint8_t, RSI::numInstructionTypes> dispatch;
+    };
+
+    static bool isFusable(RSIPass const& pass);
+    void apply(Sweep const& sweep, RSI::Function& function) const;
+    void applyFrom(
+        Sweep const& sweep, uint8_t firstPass, RSI::Instruction& instr, std::vector<RSI::Instruction>& instructions
+    ) const;
+
+    std::vector<Sweep> sweeps;
+    OutputArchitecture architecture;
+};
@@ -1,6 +1,14 @@
 #pragma once
 
 #include "R-Sharp/backend/RSI_FWD.hpp"
+#include "R-Sharp/backend/X86Assembly.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
 
 std::string rsiToAarch64(RSI::Function const& function);
+std::vector<X86::Instruction> rsiToX86(RSI::Function const& function);
 std::string rsiToNasm(RSI::Function const& function);
+// the contents of an x86-64 ELF object file, nullopt if the code can't be encoded
+std::optional<std::string> rsiToElfObject(RSI::TranslationUnit const& translationUnit);
@@ -54,6 +54,7 @@ enum class InstructionType {
     ADDRESS_OF,
     SET_LIVE,
 };
+constexpr size_t numInstructionTypes = size_t(InstructionType::SET_LIVE) + 1;
 
 extern const std::map<InstructionType, uint> numArgumentsUsed;
 extern const std::map<InstructionType, std::string> mnemonics;
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "R-Sharp/backend/Architecture.hpp"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+
+/*
+The x86-64 instructions the RSI backend produces, before they are either
+printed as NASM source or encoded into an object file directly.
+
+Names of symbols are views into the RSI labels and global references, which
+have to outlive the instructions.
+*/
+namespace X86 {
+
+struct Register {
+    NasmRegisters reg;
+    // in bytes: 8, 4 or 1
+    uint8_t size = 8;
+};
+struct Immediate {
+    int64_t value;
+};
+// the address of a label or global variable
+struct Symbol {
+    std::string_view name;
+};
+struct Memory {
+    std::optional<NasmRegisters> base{};
+    // empty if the address isn't relative to a symbol
+    std::string_view symbol{};
+    // not printed if empty, "[rsp]" and "[rsp+0]" are both valid
+    std::optional<int64_t> displacement{};
+    // the size NASM is told in front of the address ("QWORD [rsp+8]"), 0 if it is left out
+    uint8_t sizeKeyword = 0;
+};
+// an operand that can't be encoded, its text is kept for the NASM source, where the assembler reports it
+struct Invalid {
+    std::string text;
+};
+using Operand = std::variant<Register, Immediate, Symbol, Memory, Invalid>;
+
+enum class Mnemonic {
+    ADD,
+    SUB,
+    IMUL,
+    IDIV,
+    CQO,
+    NEG,
+    NOT,
+    CMP,
+    MOV,
+    MOVZX,
+    SETE,
+    SETNE,
+    SETL,
+    SETLE,
+    SETG,
+    SETGE,
+    JMP,
+    JE,
+    CALL,
+    RET,
+    PUSH,
+    POP,
+    // defines the label given as the only operand
+    LABEL,
+};
+
+struct Instruction {
+    Mnemonic mnemonic;
+    std::array<Operand, 2> operands{};
+    uint8_t numOperands = 0;
+    // NASM's size keyword after the mnemonic, "mov QWORD rax, 1", makes the instruction 64 bit
+    bool hasQwordKeyword = false;
+};
+
+Instruction makeInstruction(Mnemonic mnemonic, bool hasQwordKeyword = false);
+Instruction makeInstruction(Mnemonic mnemonic, Operand operand, bool hasQwordKeyword = false);
+Instruction makeInstruction(Mnemonic mnemonic, Operand destination, Operand source, bool hasQwordKeyword = false);
+
+inline bool isMemory(Operand const& operand) {
+    return std::holds_alternative<Memory>(operand);
+}
+
+std::string toNasm(Operand const& operand);
+// one line of NASM source, without the line break
+std::string toNasm(Instruction const& instruction);
+
+} // namespace X86
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "R-Sharp/backend/X86Assembly.hpp"
+
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+Encodes X86::Instructions into x86-64 machine code, as NASM would assemble the
+printed instructions in BITS 64 mode.
+
+Jumps and calls always take a 32 bit displacement. The ones to labels encoded by
+the same encoder are resolved by finish(), all other symbols become relocations.
+Global variables are addressed relative to the instruction pointer.
+Instructions that can't be encoded are reported as errors.
+*/
+class X86Encoder {
+public:
+    struct Relocation {
+        size_t offset;
+        std::string_view symbol;
+        // one of the ELF R_X86_64_* types
+        uint32_t type;
+        int64_t addend;
+    };
+
+    // appends the instruction to the code, false if it can't be encoded
+    bool encode(X86::Instruction const& instruction);
+    // resolves the jumps and calls to labels of the code, call it once everything is encoded
+    void finish();
+
+    std::vector<uint8_t> const& getCode() const {
+        return code;
+    }
+    // the offsets of the labels in the code
+    std::unordered_map<std::string_view, size_t> const& getLabels() const {
+        return labels;
+    }
+    std::vector<Relocation> const& getRelocations() const {
+        return relocations;
+    }
+
+private:
+    struct Branch {
+        // where the 32 bit displacement is
+        size_t offset;
+        std::string_view target;
+    };
+
+    bool encodeTwoOperands(
+        X86::Instruction const& instruction, uint8_t opcodeToMemory, uint8_t opcodeToRegister, uint8_t immediateDigit
+    );
+    bool encodeMove(X86::Instruction const& instruction);
+    bool encodeOneOperand(X86::Instruction const& instruction, uint8_t digit);
+
+    // REX prefix, opcode and ModRM with SIB and displacement, the immediate is left to the caller
+    bool emitModRM(
+        std::initializer_list<uint8_t> opcode,
+        bool is64Bit,
+        uint8_t reg,
+        bool regIsByte,
+        X86::Operand const& rm,
+        size_t immediateSize = 0
+    );
+    void emitImmediate(int64_t value, size_t size);
+    void emitSymbol(std::string_view symbol, uint32_t type, int64_t addend, size_t size);
+
+    bool fail(X86::Instruction const& instruction, std::string_view reason) const;
+
+    std::vector<uint8_t> code;
+    std::unordered_map<std::string_view, size_t> labels;
+    std::vector<Branch> branches;
+    std::vector<Relocation> relocations;
+};
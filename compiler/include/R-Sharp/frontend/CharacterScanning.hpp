@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+/*
+Bulk character scanning for the tokenizer.
+
+Each function returns the length of the run of matching characters at the
+start of `text`. On x86 they test 16 (SSE2) or 32 (AVX2, if the CPU supports
+it) characters at once, everywhere else they fall back to a plain loop.
+*/
+
+// ' ', '\t', '\n', '\v', '\f' and '\r'
+size_t spanWhitespace(std::string_view text);
+// [a-zA-Z0-9_]
+size_t spanIdentifierCharacters(std::string_view text);
+// [0-9]
+size_t spanDigits(std::string_view text);
+
+constexpr bool isWhitespace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+constexpr bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+constexpr bool isIdentifierBegin(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+constexpr bool isIdentifierCharacter(char c) {
+    return isIdentifierBegin(c) || isDigit(c);
+}
@@ -5,11 +5,14 @@
 #include "R-Sharp/frontend/ParsingCache.hpp"
 #include "R-Sharp/Utils/ScopeGuard.hpp"
 
+#include <initializer_list>
 #include <string>
 #include <memory>
 #include <vector>
 #include <sstream>
 
+class ThreadPool;
+
 class ParsingError : public std::exception {
 public:
     ParsingError(const std::string& message): message(message) {}
@@ -39,7 +42,19 @@ class Parser {
 public:
     Parser(std::vector<Token> const& tokens, std::string const& filename, std::string const& importSearchPath, ParsingCache& cache);
 
+    // parses the file and everything it imports
     std::shared_ptr<AstProgram> parse();
+    std::shared_ptr<AstProgram> parse(ParsingCache::ParsedFile file);
+    // parses only the file itself, its imports are left to parse(file)
+    ParsingCache::ParsedFile parseSyntax();
+
+    /*
+    Tokenizes and parses all files the file imports, directly or through other
+    files, concurrently on `threadPool`. The results wait in the cache until
+    parse() resolves the imports in order. Throws the FatalError of a file that
+    fails on a thread of `threadPool`.
+    */
+    void preloadImports(ThreadPool& threadPool);
 
     bool hasErrors() const {
         return hasError;
@@ -48,30 +63,35 @@ public:
 private:
     bool match(TokenType type) const;
     bool match(TokenType type, std::string value) const;
-    bool match(std::vector<TokenType> types) const;
-    bool matchAny(std::vector<TokenType> types) const;
+    bool match(std::initializer_list<TokenType> types) const;
+    bool matchAny(std::initializer_list<TokenType> types) const;
 
     bool match(int offset, TokenType type) const;
     bool match(int offset, TokenType type, std::string value) const;
-    bool match(int offset, std::vector<TokenType> types) const;
-    bool matchAny(int offset, std::vector<TokenType> types) const;
+    bool match(int offset, std::initializer_list<TokenType> types) const;
+    bool matchAny(int offset, std::initializer_list<TokenType> types) const;
 
     Token consume();
     Token consume(TokenType type);
     Token consume(TokenType type, std::string value);
-    Token consume(std::vector<TokenType> types);
-    Token consumeAnyOne(std::vector<TokenType> types);
+    Token consume(std::initializer_list<TokenType> types);
+    Token consumeAnyOne(std::initializer_list<TokenType> types);
 
     bool isAtEnd(int offset = 0) const;
 
     Token getCurrentToken() const;
     Token getToken(int offset) const;
+    // EndOfFile past the end of the tokens
+    TokenType getTokenType(int offset = 0) const;
+
+    // whether the current token can start an expression or an import statement
+    bool isExpressionStart() const;
+    bool isImportStatementStart() const;
 
     template <typename... Args>
     void parserError(Args... args) const {
-        throw ParsingError(stringify(
-            filename, ":", getCurrentToken().position.line, ":", getCurrentToken().position.column, ":\t", args...
-        ));
+        auto token = getCurrentToken();
+        throw ParsingError(stringify(filename, ":", token.getLine(), ":", token.getColumn(), ":\t", args...));
     }
     bool hasError = false;
     bool isRecovering = false;
@@ -84,14 +104,33 @@ private:
     ParsingCache& cache;
 
     std::shared_ptr<AstProgram> program;
+    std::vector<ParsingCache::Import> imports;
+
+    static std::string getImportFilePath(
+        std::vector<std::string_view> importPath, std::string const& importingFile, std::string const& importSearchPath
+    );
+    // submits every file imported in `tokens` that isn't preloaded yet
+    static void scheduleImports(
+        std::vector<Token> const& tokens,
+        std::string const& filename,
+        std::string const& importSearchPath,
+        ParsingCache& cache,
+        ThreadPool& threadPool
+    );
+    static void preloadFile(
+        std::string const& filename, std::string const& importSearchPath, ParsingCache& cache, ThreadPool& threadPool
+    );
 
     std::shared_ptr<AstProgram> parseProgram();
     std::shared_ptr<AstParameterList> parseParameterList();
 
     std::shared_ptr<AstProgramItem> parseProgramItem();
+    // records the error and skips ahead to recover from it
+    std::shared_ptr<AstErrorProgramItem> makeProgramItemError(ParsingError const& error);
     std::shared_ptr<AstFunctionDefinition> parseFunctionDefinition();
     std::shared_ptr<AstVariableDeclaration> parseGlobalVariableDefinition();
-    std::vector<std::shared_ptr<AstProgramItem>> parseImportStatement();
+    ParsingCache::Import parseImportStatement();
+    std::vector<std::shared_ptr<AstProgramItem>> resolveImport(ParsingCache::Import const& import);
 
     std::shared_ptr<AstStatement> parseStatement();
     std::shared_ptr<AstExpression> parseExpression();
@@ -108,20 +147,19 @@ private:
     std::shared_ptr<AstBreak> parseBreak();
     std::shared_ptr<AstSkip> parseSkip();
 
-    std::shared_ptr<AstExpression> parseConditionalExpression();
-    std::shared_ptr<AstExpression> parseLogicalAndExp();
-    std::shared_ptr<AstExpression> parseLogicalOrExp();
-    std::shared_ptr<AstExpression> parseEqualityExp();
-    std::shared_ptr<AstExpression> parseRelationalExp();
-    std::shared_ptr<AstExpression> parseAdditiveExp();
-    std::shared_ptr<AstExpression> parseMultiplicativeExp();
+    /*
+    Expressions are parsed by precedence climbing: the operand on the left is
+    parsed first and then combined with every following binary operator that
+    binds at least as tightly as `minPrecedence`.
+    */
+    std::shared_ptr<AstExpression> parseConditionalExpression(std::shared_ptr<AstExpression> operand);
+    std::shared_ptr<AstExpression> parseBinaryExp(std::shared_ptr<AstExpression> lhs, int minPrecedence);
     std::shared_ptr<AstExpression> parsePrefixExp();
     std::shared_ptr<AstExpression> parsePostfixExp();
     std::shared_ptr<AstExpression> parsePrimaryExp();
 
 
-    std::shared_ptr<AstAssignLocation> parseAssignmentLocation();
-    std::shared_ptr<AstAssignment> parseAssignment();
+    std::shared_ptr<AstAssignment> parseAssignment(std::shared_ptr<AstExpression> lvalue);
 
     std::shared_ptr<AstExpression> parseNumber();
     std::shared_ptr<AstFunctionCall> parseFunctionCall();
@@ -146,6 +184,9 @@ private:
     token, it will throw an exception of type ParsingError.
     The checkpoint will restore the parser to the state it
     was in when the checkpoint was created.
+
+    The grammar is parsed with a fixed lookahead, so exceptions are only
+    thrown for actual syntax errors and never to pick between alternatives.
     */
     [[nodiscard]] ScopeGuard getTokenCheckpoint() {
         const int savedTokenIndex = currentTokenIndex;
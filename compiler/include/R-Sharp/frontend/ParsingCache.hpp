@@ -1,11 +1,21 @@
 #pragma once
 
+#include "R-Sharp/ast/AstNodesFWD.hpp"
 
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
 #include <unordered_set>
 #include <string>
 #include <vector>
 
+#include <sys/types.h>
+
+/*
+Everything the parsers of one compilation share about the files they import.
+Its member functions can be called from several threads at once.
+*/
 class ParsingCache {
 public:
     ParsingCache() {}
@@ -16,7 +26,78 @@ public:
     void add(std::string const& filename, std::string const& identifier);
     void addWildcard(std::string const& filename);
 
+    /*
+    Every file is tokenized and parsed once per compilation, later imports
+    select their items from the module that was parsed first.
+    */
+    struct Module {
+        std::vector<std::shared_ptr<AstProgramItem>> items;
+        bool hasErrors = false;
+        // a module that isn't parsed yet is imported by one of its own imports
+        bool isParsed = false;
+    };
+    // nullptr if the file wasn't parsed before
+    Module* getModule(std::string const& filename);
+    Module& addModule(std::string const& filename);
+
+    struct Import {
+        std::string path;
+        std::vector<Token> identifiers;
+        bool importEverything = false;
+        // the imported items go in front of this item of the importing file
+        size_t position = 0;
+    };
+    /*
+    A file parsed on its own, with its imports left unresolved. Imported files
+    are parsed like this ahead of time and concurrently, resolving their imports
+    when they are actually imported keeps the result independent of the order
+    in which they were parsed.
+    */
+    struct ParsedFile {
+        std::shared_ptr<AstProgram> program;
+        std::vector<Import> imports;
+        bool hasErrors = false;
+    };
+    // true only the first time it is called for a file
+    bool reservePreload(std::string const& filename);
+    void addParsedFile(std::string const& filename, ParsedFile file);
+    // the file parsed ahead of time, if there is one
+    std::optional<ParsedFile> takeParsedFile(std::string const& filename);
+
 private:
-    std::unordered_map<std::string, std::vector<std::string>> filenamesToAlreadyImportedIdentifiers;
-    std::unordered_set<std::string> wildcardIncludedFiles;
+    /*
+    Files are identified by their device and inode, so every path leading to
+    the same file shares one entry. Each path is only looked up in the file
+    system the first time it is used.
+    */
+    struct FileId {
+        dev_t device;
+        ino_t inode;
+
+        bool operator==(FileId const& other) const {
+            return device == other.device && inode == other.inode;
+        }
+    };
+    struct FileIdHash {
+        size_t operator()(FileId const& id) const {
+            return std::hash<ino_t>()(id.inode) * 31 + std::hash<dev_t>()(id.device);
+        }
+    };
+    struct File {
+        std::unordered_set<std::string> importedIdentifiers;
+        bool isWildcardIncluded = false;
+        std::optional<Module> module;
+
+        bool isPreloading = false;
+        std::optional<ParsedFile> parsedFile;
+    };
+
+    File& getFile(std::string const& filename);
+
+    std::unordered_map<std::string, FileId> pathsToFileIds;
+    std::unordered_map<FileId, File, FileIdHash> files;
+    // files that don't exist get made up ids, they still have to be told apart
+    ino_t nextMissingFileId = 0;
+
+    std::mutex mutex;
 };
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+The contents of a source file, mapped into memory once.
+
+Tokens and everything built from them refer into this buffer, so source files
+are never moved or unloaded until the compiler exits. load() hands out a
+reference that stays valid for the whole run.
+
+Line and column numbers are only needed to report errors, so they are computed
+from byte offsets on demand. The offsets at which lines start are collected the
+first time a location is requested, after that a lookup is a binary search.
+*/
+struct SourceLocation {
+    int line;
+    int column;
+};
+
+class SourceFile {
+public:
+    static SourceFile const& load(std::string const& filename);
+
+    std::string const& getFilename() const {
+        return filename;
+    }
+    std::string_view getContent() const {
+        return content;
+    }
+
+    SourceLocation getLocation(size_t offset) const;
+    // the text of a line (starting at 1) without its line break
+    std::string_view getLine(int line) const;
+    size_t getLineStart(int line) const;
+
+    SourceFile(SourceFile const&) = delete;
+    SourceFile& operator=(SourceFile const&) = delete;
+    ~SourceFile();
+
+private:
+    SourceFile(std::string const& filename);
+
+    std::string filename;
+    std::string_view content;
+
+    // set if the file couldn't be mapped and was read instead
+    std::string readContent;
+    bool isMapped = false;
+
+    std::vector<size_t> const& getLineStarts() const;
+    mutable std::vector<size_t> lineStarts;
+    mutable std::once_flag lineStartsFlag;
+};
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <string>
-#include <memory>
+#include <string_view>
 
 enum class TokenType {
     None,      //
@@ -70,35 +70,32 @@ enum class TokenType {
 struct TokenLocation {
     size_t startPos;
     size_t endPos;
-    int line;
-    int column;
 };
 
+class SourceFile;
+
+/*
+A token only refers into its source file, copying it doesn't allocate.
+Its line and column are looked up in the source file when they are needed.
+*/
 struct Token {
-    Token(): type(TokenType::None), value("") {}
-    Token(TokenType type, std::string value, TokenLocation position, std::shared_ptr<std::string> source) {
-        this->type = type;
-        this->value = value;
-        this->position = position;
-        this->source = source;
-    }
-
-    Token(TokenType type, char value, TokenLocation position, std::shared_ptr<std::string> source) {
-        this->type = type;
-        this->value = std::string(1, value);
-        this->position = position;
-        this->source = source;
-    }
-    Token(TokenType type, std::string value): type(type), value(value) {}
+    Token(): type(TokenType::None) {}
+    Token(TokenType type, std::string_view value, TokenLocation position, SourceFile const* source)
+        : type(type), value(value), position(position), source(source) {}
+    Token(TokenType type, std::string_view value): type(type), value(value) {}
 
     std::string toString() const;
 
+    // 0 for tokens that don't come from a source file
+    int getLine() const;
+    int getColumn() const;
+
     TokenType type;
-    std::string value = "";
+    std::string_view value = "";
 
     TokenLocation position;
 
-    std::shared_ptr<std::string> source;
+    SourceFile const* source = nullptr;
 };
 
 std::string tokenTypeToString(TokenType type);
\ No newline at end of file
@@ -1,38 +1,42 @@
 #pragma once
 
 #include "R-Sharp/frontend/Token.hpp"
+#include "R-Sharp/frontend/SourceFile.hpp"
 #include "R-Sharp/Logging.hpp"
 
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <memory>
 
 class Tokenizer {
 public:
     Tokenizer(std::string const& filename);
 
+    // prints the errors and exits if the file has any
     std::vector<Token> tokenize();
-    std::string getSource() const {
+    // only collects the errors, several files can be tokenized like this at once
+    std::vector<Token> tokenizeQuietly();
+    std::vector<std::string> const& getErrors() const {
+        return errors;
+    }
+    std::string_view getSource() const {
         return source;
     };
 
 private:
     Token nextToken();
+    // the token from `startPos` up to the current position
+    Token makeToken(TokenType type, size_t startPos) const;
 
     bool match(char c) const;
-    bool match(std::string str) const;
-    bool matchAny(std::string str) const;
-
-    bool match(int offset, char c) const;
-    bool match(int offset, std::string str) const;
-    bool matchAny(int offset, std::string str) const;
+    bool match(std::string_view str) const;
 
     char consume();
     char consume(char c);
-    std::string consume(std::string str);
-    std::string consumeAny(std::string str);
-    char consumeAnyOne(std::string str);
-    std::string consumeUntil(std::string str);
+    bool consume(std::string_view str);
+    // skip `count` characters at once
+    void advance(size_t count);
 
     bool isAtEnd(int offset = 0) const;
 
@@ -41,14 +45,17 @@ private:
 
     template <typename... Args>
     void logError(Args... args) {
-        Error(filename, ":", line, ":", column, ":\t", args...);
+        auto location = sourceFile.getLocation(currentPosition);
+        std::stringstream message;
+        message << filename << ":" << location.line << ":" << location.column << ":\t";
+        (message << ... << args);
+        errors.push_back(message.str());
     }
+    std::vector<std::string> errors;
 
-    std::string source;
+    SourceFile const& sourceFile;
+    std::string_view source;
     size_t currentPosition;
-    int line = 1;
-    int column = 1;
 
     const std::string filename;
-    std::shared_ptr<std::string> source_ptr;
 };
\ No newline at end of file
@@ -3,10 +3,11 @@
 #include "R-Sharp/frontend/Token.hpp"
 
 #include <string>
+#include <string_view>
 #include <vector>
 
-std::string escapeString(std::string const& str);
+std::string escapeString(std::string_view str);
 
 // removes comments and non-code tokens
-std::vector<Token> cleanTokens(std::vector<Token> const& tokens);
+void cleanTokens(std::vector<Token>& tokens);
 
@@ -0,0 +1,18 @@
+#include "R-Sharp/Utils/AllocationCounter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+std::atomic<size_t> numAllocations = 0;
+
+void* operator new(size_t size) {
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
@@ -0,0 +1,110 @@
+#include "R-Sharp/Utils/Statistics.hpp"
+#include "R-Sharp/Utils/AllocationCounter.hpp"
+#include "R-Sharp/Utils/Json.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+#include <sys/resource.h>
+
+namespace {
+size_t getPeakRssKiB() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+double toMilliseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+} // namespace
+
+Statistics::Phase::Phase(Statistics* statistics, std::string name) :
+    statistics(statistics), traceEvent(Trace::get().event(name)) {
+    if (!statistics) return;
+
+    index = statistics->phases.size();
+    statistics->phases.push_back({.name = std::move(name), .depth = statistics->depth++});
+    allocationsBefore = numAllocations.load(std::memory_order_relaxed);
+    start = std::chrono::steady_clock::now();
+}
+
+Statistics::Phase::~Phase() {
+    if (!statistics) return;
+
+    auto& data = statistics->phases.at(index);
+    data.time = std::chrono::steady_clock::now() - start;
+    data.allocations = numAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+    data.peakRssKiB = getPeakRssKiB();
+    statistics->depth--;
+}
+
+void Statistics::Phase::setInstructionCounts(size_t before, size_t after) {
+    if (!statistics) return;
+
+    auto& data = statistics->phases.at(index);
+    data.instructionsBefore = before;
+    data.instructionsAfter = after;
+}
+
+Statistics& Statistics::get() {
+    static Statistics statistics;
+    return statistics;
+}
+
+void Statistics::enable() {
+    enabled = true;
+    start = std::chrono::steady_clock::now();
+}
+
+Statistics::Phase Statistics::phase(std::string name) {
+    return Phase(enabled ? this : nullptr, std::move(name));
+}
+
+void Statistics::printTable(std::ostream& stream) const {
+    auto total = std::chrono::steady_clock::now() - start;
+
+    stream << "--------------| Time report |--------------\n";
+    stream << " time [ms]  allocations  peak RSS [MiB]         instructions  phase\n";
+    for (auto const& phase : phases) {
+        std::stringstream line;
+        line << std::fixed << std::setprecision(3) << std::setw(10) << toMilliseconds(phase.time) << "  "
+             << std::setw(11) << phase.allocations << "  " << std::setprecision(1) << std::setw(14)
+             << phase.peakRssKiB / 1024.0 << "  ";
+
+        std::string instructions;
+        if (phase.instructionsBefore && phase.instructionsAfter)
+            instructions = std::to_string(*phase.instructionsBefore) + " -> " + std::to_string(*phase.instructionsAfter);
+        line << std::setw(19) << instructions << "  " << std::string(phase.depth * 2, ' ') << phase.name;
+        stream << line.str() << '\n';
+    }
+
+    std::stringstream line;
+    line << std::fixed << std::setprecision(3) << std::setw(10) << toMilliseconds(total) << "  " << std::setw(11)
+         << numAllocations.load(std::memory_order_relaxed) << "  " << std::setprecision(1) << std::setw(14)
+         << getPeakRssKiB() / 1024.0 << "  " << std::setw(19) << "" << "  total";
+    stream << line.str() << '\n';
+}
+
+void Statistics::printJson(std::ostream& stream) const {
+    auto total = std::chrono::steady_clock::now() - start;
+
+    stream << std::fixed << std::setprecision(3);
+    stream << "{\n";
+    stream << "  \"totalTimeMs\": " << toMilliseconds(total) << ",\n";
+    stream << "  \"allocations\": " << numAllocations.load(std::memory_order_relaxed) << ",\n";
+    stream << "  \"peakRssKiB\": " << getPeakRssKiB() << ",\n";
+    stream << "  \"phases\": [";
+    for (size_t i = 0; i < phases.size(); i++) {
+        auto const& phase = phases[i];
+        stream << (i ? ",\n" : "\n") << "    {\"name\": \"" << escapeJson(phase.name) << "\", \"depth\": " << phase.depth
+               << ", \"timeMs\": " << toMilliseconds(phase.time) << ", \"allocations\": " << phase.allocations
+               << ", \"peakRssKiB\": " << phase.peakRssKiB;
+        if (phase.instructionsBefore && phase.instructionsAfter) {
+            stream << ", \"instructionsBefore\": " << *phase.instructionsBefore
+                   << ", \"instructionsAfter\": " << *phase.instructionsAfter;
+        }
+        stream << "}";
+    }
+    stream << "\n  ]\n}\n";
+}
@@ -0,0 +1,81 @@
+#include "R-Sharp/Utils/Trace.hpp"
+#include "R-Sharp/Utils/Json.hpp"
+
+#include <fstream>
+#include <iomanip>
+
+namespace {
+double toMicroseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+} // namespace
+
+Trace::Event::Event(Trace* trace, std::string_view name, std::string_view detail) : trace(trace) {
+    if (!trace) return;
+
+    this->name = name;
+    this->detail = detail;
+    start = std::chrono::steady_clock::now();
+}
+
+Trace::Event::~Event() {
+    if (!trace) return;
+
+    auto end = std::chrono::steady_clock::now();
+    trace->getThread().records.push_back(Record{
+        .name = std::move(name),
+        .detail = std::move(detail),
+        .start = toMicroseconds(start - trace->start),
+        .duration = toMicroseconds(end - start),
+    });
+}
+
+Trace& Trace::get() {
+    static Trace trace;
+    return trace;
+}
+
+void Trace::enable() {
+    enabled = true;
+    start = std::chrono::steady_clock::now();
+    getThread();
+}
+
+Trace::Event Trace::event(std::string_view name, std::string_view detail) {
+    return Event(enabled ? this : nullptr, name, detail);
+}
+
+Trace::Thread& Trace::getThread() {
+    // there is only one Trace, so a thread only needs to remember one list
+    static thread_local Thread* thread = nullptr;
+    if (!thread) {
+        std::lock_guard lock(mutex);
+        threads.push_back(std::make_unique<Thread>(Thread{.id = threads.size(), .records = {}}));
+        thread = threads.back().get();
+    }
+    return *thread;
+}
+
+bool Trace::write(std::string const& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) return false;
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    bool isFirst = true;
+    for (auto const& thread : threads) {
+        file << (isFirst ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread->id
+             << ", \"args\": {\"name\": \"" << (thread->id == 0 ? "main" : "worker " + std::to_string(thread->id))
+             << "\"}}";
+        isFirst = false;
+
+        for (auto const& record : thread->records) {
+            file << ",\n{\"name\": \"" << escapeJson(record.name) << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+                 << thread->id << ", \"ts\": " << record.start << ", \"dur\": " << record.duration;
+            if (!record.detail.empty()) file << ", \"args\": {\"detail\": \"" << escapeJson(record.detail) << "\"}";
+            file << "}";
+        }
+    }
+    file << "\n]}\n";
+    return file.good();
+}
@@ -0,0 +1,54 @@
+#include "R-Sharp/ast/AstVisitor.hpp"
+#include "R-Sharp/ast/AstNodes.hpp"
+
+#include <utility>
+
+// an upcast, moving the pointer saves touching the reference count
+#define VISITOR_FN(NAME)                                  \
+    void AstVisitor::visit(std::shared_ptr<NAME> node) {  \
+        visit(std::shared_ptr<AstNode>(std::move(node))); \
+    }
+
+VISITOR_FN(AstProgram)
+
+VISITOR_FN(AstErrorStatement)
+VISITOR_FN(AstErrorProgramItem)
+VISITOR_FN(AstErrorExpression)
+
+VISITOR_FN(AstFunctionDefinition)
+VISITOR_FN(AstParameterList)
+
+VISITOR_FN(AstBlock)
+VISITOR_FN(AstReturn)
+VISITOR_FN(AstExpressionStatement)
+VISITOR_FN(AstConditionalStatement)
+VISITOR_FN(AstForLoopDeclaration)
+VISITOR_FN(AstForLoopExpression)
+VISITOR_FN(AstWhileLoop)
+VISITOR_FN(AstDoWhileLoop)
+VISITOR_FN(AstBreak)
+VISITOR_FN(AstSkip)
+
+VISITOR_FN(AstInteger)
+VISITOR_FN(AstArrayLiteral)
+
+VISITOR_FN(AstUnary)
+VISITOR_FN(AstBinary)
+VISITOR_FN(AstVariableAccess)
+VISITOR_FN(AstAssignment)
+VISITOR_FN(AstConditionalExpression)
+VISITOR_FN(AstEmptyExpression)
+VISITOR_FN(AstFunctionCall)
+VISITOR_FN(AstAddressOf)
+
+VISITOR_FN(AstTypeConversion)
+VISITOR_FN(AstDereference)
+VISITOR_FN(AstArrayAccess)
+VISITOR_FN(AstAssignLocation)
+
+VISITOR_FN(AstVariableDeclaration)
+VISITOR_FN(AstPointerType)
+VISITOR_FN(AstArrayType)
+VISITOR_FN(AstPrimitiveType)
+
+VISITOR_FN(AstTags)
@@ -1,5 +1,6 @@
 #include "R-Sharp/ast/SemanticValidator.hpp"
 #include "R-Sharp/ast/AstNodes.hpp"
+#include "R-Sharp/ast/TypeContext.hpp"
 #include "R-Sharp/Utils.hpp"
 #include "R-Sharp/Logging.hpp"
 #include "R-Sharp/ast/AstNodesFWD.hpp"
@@ -8,15 +9,16 @@
 #include <set>
 #include <queue>
 
-SemanticValidator::SemanticValidator(std::shared_ptr<AstNode> root, std::string const& filename, std::string const& source) {
+SemanticValidator::SemanticValidator(std::shared_ptr<AstNode> root, std::string const& filename) {
     this->root = root;
     this->filename = filename;
-    this->source = source;
 }
 
 void SemanticValidator::validate() {
     variableContexts = {};
+    variables = {};
     functions = {};
+    functionOverloads = {};
     collapseContexts = false;
     loops = {};
 
@@ -40,39 +42,33 @@ void SemanticValidator::pushContext(std::shared_ptr<AstBlock> block) {
     }
     else {
         variableContexts.push_back(block);
+        variables.pushScope();
+    }
+
+    // the variables of a merged context are declared already
+    for (auto const& var : block->variables) {
+        if (!variables.lookupInnermost(var->name)) variables.declare(var);
     }
 }
 void SemanticValidator::popContext() {
     if (variableContexts.empty()) {
         Error("INTERNAL ERROR: Invalid context pop");
+        return;
     }
     variableContexts.pop_back();
+    variables.popScope();
 }
 bool SemanticValidator::isVariableDeclared(std::string const& name) const {
-    for (auto it = variableContexts.rbegin(); it != variableContexts.rend(); it++) {
-        // TODO: use ContainerTools::contains
-        auto found = std::find_if((*it)->variables.begin(), (*it)->variables.end(), [&](auto other) {
-            if (other->name.size() == 0)
-                Error("INTERNAL ERROR: Variable without name detected");
-            return other->name == name;
-        });
-        if (found != (*it)->variables.end()) {
-            return true;
-        }
-    }
-    return false;
+    return variables.lookup(name) != nullptr;
 }
 bool SemanticValidator::isVariableDefinable(AstVariableDeclaration const& testVar) const {
-    // TODO: use ContainerTools::contains
-    auto it = std::find_if(variableContexts.back()->variables.begin(), variableContexts.back()->variables.end(), [&](auto other) {
-        return other->name == testVar.name;
-    });
-    if (it == variableContexts.back()->variables.end()) {
+    auto existing = variables.lookupInnermost(testVar.name);
+    if (!existing) {
         return true;
     }
     else {
-        if ((*it)->isGlobal && testVar.variable->isGlobal) {
-            return !(*it)->isDefined;
+        if (existing->isGlobal && testVar.variable->isGlobal) {
+            return !existing->isDefined;
         }
         else {
             return false;
@@ -80,64 +76,59 @@ bool SemanticValidator::isVariableDefinable(AstVariableDeclaration const& testVa
     }
 }
 void SemanticValidator::addVariable(std::shared_ptr<AstVariableDeclaration> var) {
-    // TODO: use ContainerTools::contains
-    auto it = std::find_if(variableContexts.back()->variables.begin(), variableContexts.back()->variables.end(), [&](auto other) {
-        return other->name == var->name;
-    });
-    if (it == variableContexts.back()->variables.end()) {
+    auto existing = variables.lookupInnermost(var->name);
+    if (!existing) {
         var->variable->isDefined = (bool)var->value;
         var->variable->name = var->name;
         var->variable->type = var->semanticType;
 
         variableContexts.back()->variables.push_back(var->variable);
+        variables.declare(var->variable);
     }
     else if (var->value) {
-        (*it)->isDefined = true;
-        var->variable = *it;
+        existing->isDefined = true;
+        var->variable = existing;
     }
 }
 std::shared_ptr<SemanticVariableData> SemanticValidator::getVariable(std::string const& name) {
-    for (auto it = variableContexts.rbegin(); it != variableContexts.rend(); it++) {
-        // TODO: use ContainerTools::contains
-        auto it2 = std::find_if((*it)->variables.begin(), (*it)->variables.end(), [&](auto other) {
-            return other->name == name;
-        });
-        if (it2 != (*it)->variables.end()) {
-            return *it2;
-        }
-    }
-    return nullptr;
+    return variables.lookup(name);
 }
 
 
-bool SemanticValidator::isFunctionDefined(std::string name) const {
-    // TODO: use ContainerTools::contains
-    const auto it = std::find_if(functions.begin(), functions.end(), [&](auto other) {
-        return other->name == name;
-    });
-    return it != functions.end();
+bool SemanticValidator::isFunctionDefined(std::string const& name) const {
+    return functions.count(name);
 }
-std::shared_ptr<SemanticFunctionData> SemanticValidator::getFunction(std::string name, std::shared_ptr<AstParameterList> params) {
-    // TODO: use ContainerTools::contains
-    auto it = std::find_if(functions.begin(), functions.end(), [&](auto other) {
-        if (other->name != name)
-            return false;
-        if (*other->parameters == *params)
-            return true;
-
-        // allow function if the parameters can be casted
-        if (other->parameters->parameters.size() != params->parameters.size()) {
+void SemanticValidator::addFunction(std::shared_ptr<AstFunctionDefinition> function) {
+    auto const& parameters = function->functionData->parameters->parameters;
+    functions.emplace(function->name, function->functionData);
+    functionOverloads[{function->name, parameters.size()}].push_back(function->functionData);
+}
+std::shared_ptr<SemanticFunctionData> SemanticValidator::getFunction(
+    std::string const& name,
+    std::shared_ptr<AstParameterList> params
+) {
+    auto overloads = functionOverloads.find({name, params->parameters.size()});
+    if (overloads == functionOverloads.end()) {
+        auto other = functions.find(name);
+        if (other != functions.end()) {
             Warning(
                 "A function named ",
                 name,
                 " was found, but it has ",
-                other->parameters->parameters.size(),
+                other->second->parameters->parameters.size(),
                 " parameters instead of ",
                 params->parameters.size()
             );
-            return false;
         }
+        return nullptr;
+    }
 
+    for (auto const& other : overloads->second) {
+        if (*other->parameters == *params) return other;
+    }
+    // allow function if the parameters can be casted
+    for (auto const& other : overloads->second) {
+        bool isCastable = true;
         for (int i = 0; i < other->parameters->parameters.size(); i++) {
             if (!areEquivalentTypesInSharedPtr(other->parameters->parameters.at(i), params->parameters.at(i))) {
                 Warning(
@@ -145,52 +136,34 @@ std::shared_ptr<SemanticFunctionData> SemanticValidator::getFunction(std::string
                     name,
                     " with the correct number of arguments was found, but it has different types"
                 );
-                return false;
+                isCastable = false;
+                break;
             }
         }
-        return true;
-    });
-    if (it == functions.end()) {
-        return nullptr;
-    }
-    else {
-        return *it;
+        if (isCastable) return other;
     }
+    return nullptr;
 }
 
+/*
+Whether a value of type b can be used as type a without a conversion.
+Pointers never are, pointer operands always get an explicit conversion. Of
+arrays only the length is compared.
+*/
+bool isEqualType(InternedType const* a, InternedType const* b) {
+    if (a->kind != b->kind)
+        return false;
+    switch (a->kind) {
+        case AstNodeType::AstPrimitiveType: return a == b;
+        case AstNodeType::AstPointerType:   return false;
+        case AstNodeType::AstArrayType:     return a->length.has_value() && a->length == b->length;
+        default:                            throw std::runtime_error("Unknown type to test equality");
+    }
+}
 bool isEqualTypeInSharedPointer(std::shared_ptr<AstType> a, std::shared_ptr<AstType> b) {
     if (!a.get() || !b.get())
         return false;
-    if (a->getType() != b->getType())
-        return false;
-    switch (a->getType()) {
-        case AstNodeType::AstPrimitiveType:
-            return std::static_pointer_cast<AstPrimitiveType>(a)->type
-                == std::static_pointer_cast<AstPrimitiveType>(b)->type;
-        case AstNodeType::AstPointerType:
-            return isEqualTypeInSharedPointer(
-                std::static_pointer_cast<AstPointerType>(a)->subtype,
-                std::static_pointer_cast<AstPointerType>(b)
-            );
-
-        case AstNodeType::AstArrayType: {
-            auto A = std::dynamic_pointer_cast<AstArrayType>(a);
-            auto B = std::dynamic_pointer_cast<AstArrayType>(b);
-            if (!A->size.has_value()) {
-                return false;
-            }
-            if (!B->size.has_value()) {
-                return false;
-            }
-
-            if (std::dynamic_pointer_cast<AstInteger>(A->size.value())->value
-                != std::dynamic_pointer_cast<AstInteger>(B->size.value())->value) {
-                return false;
-            }
-            return true;
-        }
-        default: throw std::runtime_error("Unknown type to test equality");
-    }
+    return isEqualType(TypeContext::get().intern(*a), TypeContext::get().intern(*b));
 }
 bool SemanticValidator::areEquivalentTypesInSharedPtr(std::shared_ptr<AstNode> expected, std::shared_ptr<AstNode> found) {
     requireType(expected);
@@ -200,77 +173,59 @@ bool SemanticValidator::areEquivalentTypesInSharedPtr(std::shared_ptr<AstNode> e
 }
 
 bool SemanticValidator::areEquivalentTypes(std::shared_ptr<AstType> expected, std::shared_ptr<AstType> found) {
-    static const std::vector<RSharpPrimitiveType> integerTypes = {
-        RSharpPrimitiveType::I8,
-        RSharpPrimitiveType::I16,
-        RSharpPrimitiveType::I32,
-        RSharpPrimitiveType::I64,
+    return areEquivalentTypes(TypeContext::get().intern(*expected), TypeContext::get().intern(*found));
+}
+bool SemanticValidator::areEquivalentTypes(InternedType const* expected, InternedType const* found) {
+    auto isInteger = [](InternedType const* type) {
+        return type->kind == AstNodeType::AstPrimitiveType
+            && (type->primitive == RSharpPrimitiveType::I8 || type->primitive == RSharpPrimitiveType::I16
+                || type->primitive == RSharpPrimitiveType::I32 || type->primitive == RSharpPrimitiveType::I64);
+    };
+    auto isCVoid = [](InternedType const* type) {
+        return type->kind == AstNodeType::AstPrimitiveType && type->primitive == RSharpPrimitiveType::C_void;
     };
 
     // don't issue further errors if the type is unknown already
-    if (expected->isErrorType() || found->isErrorType())
+    if (expected->isErrorType || found->isErrorType)
         return true;
 
-    switch (expected->getType()) {
+    switch (expected->kind) {
         default: {
             throw std::runtime_error("Unimplemented type used");
             break;
         }
         case AstNodeType::AstPrimitiveType: {
-            auto expected_type = std::static_pointer_cast<AstPrimitiveType>(expected)->type;
-            auto found_type = std::static_pointer_cast<AstPrimitiveType>(found)->type;
-
-            if (expected_type == found_type)
+            if (expected == found)
                 return true;
-
-            // TODO: use ContainerTools::contains
-            if (std::find(integerTypes.begin(), integerTypes.end(), expected_type) != integerTypes.end()
-                && std::find(integerTypes.begin(), integerTypes.end(), found_type) != integerTypes.end()) {
+            if (isInteger(expected) && isInteger(found))
                 return true;
-            }
-
             break;
         }
 
         case AstNodeType::AstPointerType: {
-            auto expected_type = std::static_pointer_cast<AstPointerType>(expected);
-            if (found->getType() == AstNodeType::AstPrimitiveType) {
+            if (found->kind == AstNodeType::AstPrimitiveType) {
                 // temporarily allow int to pointer conversions
-                // TODO: use ContainerTools::contains
-                const bool isValid = std::find(
-                                         integerTypes.begin(),
-                                         integerTypes.end(),
-                                         std::static_pointer_cast<AstPrimitiveType>(found)->type
-                                     )
-                                  != integerTypes.end();
+                const bool isValid = isInteger(found);
                 if (isValid)
                     Warning("Performing integer to pointer conversion.");
                 return isValid;
             }
-            else if (found->getType() == AstNodeType::AstPointerType) {
-                auto found_type = std::static_pointer_cast<AstPointerType>(found);
-                if (areEquivalentTypes(expected_type->subtype, found_type->subtype)) {
+            else if (found->kind == AstNodeType::AstPointerType) {
+                if (areEquivalentTypes(expected->subtype, found->subtype)) {
                     return true;
                 }
                 // allow *any to *c_void
-                else if (expected_type->subtype->getType() == AstNodeType::AstPrimitiveType
-                         && std::static_pointer_cast<AstPrimitiveType>(expected_type->subtype)->type
-                                == RSharpPrimitiveType::C_void) {
+                else if (isCVoid(expected->subtype)) {
                     return true;
                 }
                 // allow *c_void to *any
-                else if (found_type->subtype->getType() == AstNodeType::AstPrimitiveType
-                         && std::static_pointer_cast<AstPrimitiveType>(found_type->subtype)->type
-                                == RSharpPrimitiveType::C_void) {
-                    // a *c_void is found
+                else if (isCVoid(found->subtype)) {
                     return true;
                 }
             }
             // allow [any] to *c_void decay
-            else if (found->getType() == AstNodeType::AstArrayType) {
-                if (expected_type->subtype->getType() == AstNodeType::AstPrimitiveType
-                    && std::static_pointer_cast<AstPrimitiveType>(expected_type->subtype)->type
-                           == RSharpPrimitiveType::C_void) {
+            else if (found->kind == AstNodeType::AstArrayType) {
+                if (isCVoid(expected->subtype)) {
                     return true;
                 }
             }
@@ -278,25 +233,22 @@ bool SemanticValidator::areEquivalentTypes(std::shared_ptr<AstType> expected, st
                 return false;
             }
         }
+        // a pointer that isn't equivalent yet is compared like an unsized array
         case AstNodeType::AstArrayType: {
-            auto expected_type = std::static_pointer_cast<AstArrayType>(expected);
-
-            if (found->getType() != AstNodeType::AstArrayType) {
+            if (found->kind != AstNodeType::AstArrayType) {
                 return false;
             }
-            auto found_type = std::static_pointer_cast<AstArrayType>(found);
-            if (!isEqualTypeInSharedPointer(expected_type->subtype, found_type->subtype)) {
+            if (!isEqualType(expected->subtype, found->subtype)) {
                 return false;
             }
-            if (!expected_type->size.has_value()) {
+            if (!expected->hasSize) {
                 return true;
             }
-            if (!found_type->size.has_value()) {
+            if (!found->hasSize) {
                 return true;
             }
 
-            if (std::dynamic_pointer_cast<AstInteger>(expected_type->size.value())->value
-                != std::dynamic_pointer_cast<AstInteger>(found_type->size.value())->value) {
+            if (expected->length != found->length) {
                 return false;
             }
 
@@ -318,8 +270,8 @@ bool SemanticValidator::requireEquivalentTypes(std::shared_ptr<AstNode> expected
             found->semanticType->toString(),
             ")"
         );
-        printErrorToken(expected->token, source);
-        printErrorToken(found->token, source);
+        printErrorToken(expected->token);
+        printErrorToken(found->token);
         return true;
     }
     return false;
@@ -328,7 +280,7 @@ void SemanticValidator::requireType(std::shared_ptr<AstNode> node) {
     if (!node->semanticType) {
         hasError = true;
         Error("INTERNAL ERROR: operand doesn't have a semanticType");
-        printErrorToken(node->token, source);
+        printErrorToken(node->token);
         exit(1);
     }
 }
@@ -343,25 +295,25 @@ void SemanticValidator::visit(std::shared_ptr<AstProgram> node) {
         if (isVariableDeclared(function->name)) {
             hasError = true;
             Error("function \"", function->name, "\" is already declared as a variable");
-            printErrorToken(node->token, source);
+            printErrorToken(node->token);
         }
         if (!isFunctionDefined(function->name)) {
-            functions.push_back(function->functionData);
+            addFunction(function);
         }
         else {
             hasError = true;
             Error("function \"", function->name, "\" is already defined");
-            printErrorToken(node->token, source);
+            printErrorToken(node->token);
         }
     }
 
-    node->globalScope = std::make_shared<AstBlock>();
+    node->globalScope = makeNode<AstBlock>();
     node->globalScope->name = "Global Scope";
     // it isn't actually merged, but just marked so to avoid assembly outside of a function
     node->globalScope->isMerged = true;
     pushContext(node->globalScope);
     // visit children
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     popContext();
 
     for (auto var : node->globalScope->variables) {
@@ -372,19 +324,19 @@ void SemanticValidator::visit(std::shared_ptr<AstProgram> node) {
 
 void SemanticValidator::visit(std::shared_ptr<AstBlock> node) {
     pushContext(node);
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     popContext();
 }
 void SemanticValidator::visit(std::shared_ptr<AstReturn> node) {
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     node->semanticType = node->value->semanticType;
 
     if (requireEquivalentTypes(currentFunction, node, "return type and returned type don't match")) {
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
     }
     if (!isEqualTypeInSharedPointer(currentFunction->semanticType, node->semanticType)) {
         // apply an automaic type conversion
-        node->value = std::make_shared<AstTypeConversion>(node->value, currentFunction->semanticType);
+        node->value = makeNode<AstTypeConversion>(node->value, currentFunction->semanticType);
     }
 
     // don't copy the global scope
@@ -392,12 +344,12 @@ void SemanticValidator::visit(std::shared_ptr<AstReturn> node) {
         .insert(node->containedScopes.begin(), std::next(variableContexts.begin()), variableContexts.end());
 }
 void SemanticValidator::visit(std::shared_ptr<AstExpressionStatement> node) {
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     node->semanticType = node->expression->semanticType;
 }
 
 void SemanticValidator::visit(std::shared_ptr<AstForLoopDeclaration> node) {
-    loops.push(node->loop = std::make_shared<SemanticLoopData>());
+    loops.push(node->loop = makeNode<SemanticLoopData>());
     loops.top()->hasAdditionalCleanup = true;
     node->initializationContext->name = "for loop counter";
     variableContexts.back()->hasLoopCurrently = true;
@@ -406,26 +358,26 @@ void SemanticValidator::visit(std::shared_ptr<AstForLoopDeclaration> node) {
     loops.pop();
 }
 void SemanticValidator::visit(std::shared_ptr<AstForLoopExpression> node) {
-    loops.push(node->loop = std::make_shared<SemanticLoopData>());
+    loops.push(node->loop = makeNode<SemanticLoopData>());
     loops.top()->hasAdditionalCleanup = false;
     variableContexts.back()->hasLoopCurrently = true;
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     variableContexts.back()->hasLoopCurrently = false;
     loops.pop();
 }
 void SemanticValidator::visit(std::shared_ptr<AstWhileLoop> node) {
-    loops.push(node->loop = std::make_shared<SemanticLoopData>());
+    loops.push(node->loop = makeNode<SemanticLoopData>());
     loops.top()->hasAdditionalCleanup = false;
     variableContexts.back()->hasLoopCurrently = true;
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     variableContexts.back()->hasLoopCurrently = false;
     loops.pop();
 }
 void SemanticValidator::visit(std::shared_ptr<AstDoWhileLoop> node) {
-    loops.push(node->loop = std::make_shared<SemanticLoopData>());
+    loops.push(node->loop = makeNode<SemanticLoopData>());
     loops.top()->hasAdditionalCleanup = false;
     variableContexts.back()->hasLoopCurrently = true;
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     variableContexts.back()->hasLoopCurrently = false;
     loops.pop();
 }
@@ -437,7 +389,7 @@ void SemanticValidator::visit(std::shared_ptr<AstBreak> node) {
     if (loops.empty() || it == variableContexts.rend()) {
         hasError = true;
         Error("Break statement outside of loop");
-        printErrorToken(node->token, source);
+        printErrorToken(node->token);
     }
     else {
         node->loop = loops.top();
@@ -460,7 +412,7 @@ void SemanticValidator::visit(std::shared_ptr<AstSkip> node) {
     if (loops.empty() || it == variableContexts.rend()) {
         hasError = true;
         Error("Skip statement outside of loop");
-        printErrorToken(node->token, source);
+        printErrorToken(node->token);
     }
     else {
         node->loop = loops.top();
@@ -469,60 +421,60 @@ void SemanticValidator::visit(std::shared_ptr<AstSkip> node) {
 }
 
 void SemanticValidator::visit(std::shared_ptr<AstUnary> node) {
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     requireType(node->value);
     node->semanticType = node->value->semanticType;
 }
 void SemanticValidator::visit(std::shared_ptr<AstBinary> node) {
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     if (node->left->semanticType->getType() == AstNodeType::AstPrimitiveType
         && std::static_pointer_cast<AstPrimitiveType>(node->left->semanticType)->type == RSharpPrimitiveType::C_void) {
         hasError = true;
         Error("expressions may not have type c_void");
-        printErrorToken(node->left->token, source);
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        printErrorToken(node->left->token);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
         return;
     }
     if (node->right->semanticType->getType() == AstNodeType::AstPrimitiveType
         && std::static_pointer_cast<AstPrimitiveType>(node->right->semanticType)->type == RSharpPrimitiveType::C_void) {
         hasError = true;
         Error("expressions may not have type c_void");
-        printErrorToken(node->right->token, source);
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        printErrorToken(node->right->token);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
         return;
     }
     if (requireEquivalentTypes(node->left, node->right, "Binary operands don't match in semantical type")) {
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
         return;
     }
     if (!isEqualTypeInSharedPointer(node->left->semanticType, node->right->semanticType)) {
         if (node->left->semanticType->getType() != AstNodeType::AstPointerType
             && node->right->semanticType->getType() != AstNodeType::AstPointerType) {
             // apply an automatic type conversion
-            node->right = std::make_shared<AstTypeConversion>(node->right, node->left->semanticType);
+            node->right = makeNode<AstTypeConversion>(node->right, node->left->semanticType);
         }
         else {
             // one of the types is a pointer
             if (node->type != AstBinaryType::Subtract && node->type != AstBinaryType::Add) {
                 hasError = true;
                 Error("Two pointers can only be added and subtracted.");
-                printErrorToken(node->token, source);
-                node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+                printErrorToken(node->token);
+                node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
                 return;
             }
             else {
                 if (node->left->semanticType->getType() == AstNodeType::AstPointerType) {
                     // apply an automaic type conversion
-                    node->right = std::make_shared<AstTypeConversion>(
+                    node->right = makeNode<AstTypeConversion>(
                         node->right,
-                        std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::I64)
+                        makeNode<AstPrimitiveType>(RSharpPrimitiveType::I64)
                     );
                 }
                 if (node->right->semanticType->getType() == AstNodeType::AstPointerType) {
                     // apply an automaic type conversion
-                    node->left = std::make_shared<AstTypeConversion>(
+                    node->left = makeNode<AstTypeConversion>(
                         node->left,
-                        std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::I64)
+                        makeNode<AstPrimitiveType>(RSharpPrimitiveType::I64)
                     );
                 }
             }
@@ -530,7 +482,7 @@ void SemanticValidator::visit(std::shared_ptr<AstBinary> node) {
     }
 
     if (node->left->semanticType->isErrorType() || node->right->semanticType->isErrorType()) {
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
     }
     else {
         node->semanticType = node->left->semanticType;
@@ -550,22 +502,22 @@ void SemanticValidator::visit(std::shared_ptr<AstVariableAccess> node) {
     else {
         hasError = true;
         Error("variable \"", node->name, "\" is not declared");
-        printErrorToken(node->token, source);
+        printErrorToken(node->token);
 
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
     }
 }
 void SemanticValidator::visit(std::shared_ptr<AstDereference> node) {
     node->operand->accept(this);
     if (node->operand->semanticType->isErrorType()) {
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
         return;
     }
     if (node->operand->semanticType->getType() != AstNodeType::AstPointerType) {
         hasError = true;
         Error("Cannot dereference here! Not a pointer.");
-        printErrorToken(node->token, source);
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        printErrorToken(node->token);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
         return;
     }
     if (std::static_pointer_cast<AstPointerType>(node->operand->semanticType)->subtype->getType() == AstNodeType::AstPrimitiveType
@@ -576,8 +528,8 @@ void SemanticValidator::visit(std::shared_ptr<AstDereference> node) {
                == RSharpPrimitiveType::C_void) {
         hasError = true;
         Error("Cannot dereference pointer of type *c_void");
-        printErrorToken(node->operand->token, source);
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        printErrorToken(node->operand->token);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
         return;
     }
     else {
@@ -591,8 +543,8 @@ void SemanticValidator::visit(std::shared_ptr<AstArrayAccess> node) {
     if (node->array->semanticType->getType() != AstNodeType::AstArrayType) {
         hasError = true;
         Error("Can only index into array, but got ", node->array->semanticType->toString(), "\n");
-        printErrorToken(node->array->token, source);
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        printErrorToken(node->array->token);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
         return;
     }
 
@@ -606,8 +558,8 @@ void SemanticValidator::visit(std::shared_ptr<AstArrayAccess> node) {
     if (validTypesToIndexInto.count(node->array->getType()) == 0) {
         hasError = true;
         Error("Indexing into ", node->array->toString(), " is not currently supported\n");
-        printErrorToken(node->array->token, source);
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        printErrorToken(node->array->token);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
         return;
     }
 
@@ -618,8 +570,8 @@ void SemanticValidator::visit(std::shared_ptr<AstArrayLiteral> node) {
     if (node->elements.size() == 0) {
         hasError = true;
         Error("Zero length array literals aren't supported yet.\n");
-        printErrorToken(node->token, source);
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        printErrorToken(node->token);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
         return;
     }
 
@@ -630,13 +582,13 @@ void SemanticValidator::visit(std::shared_ptr<AstArrayLiteral> node) {
         element->accept(this);
         requireType(element);
         if (element->semanticType->isErrorType()) {
-            node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+            node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
             return;
         }
         if (i == 0) {
             elementType = element->semanticType;
-            node->semanticType = std::make_shared<AstArrayType>(elementType);
-            std::static_pointer_cast<AstArrayType>(node->semanticType)->size = std::make_shared<AstInteger>(
+            node->semanticType = makeNode<AstArrayType>(elementType);
+            std::static_pointer_cast<AstArrayType>(node->semanticType)->size = makeNode<AstInteger>(
                 node->elements.size()
             );
             node->semanticType->accept(this);
@@ -645,14 +597,14 @@ void SemanticValidator::visit(std::shared_ptr<AstArrayLiteral> node) {
 
         requireEquivalentTypes(firstElement, element, "Array element doesn't have the correct type");
         if (!isEqualTypeInSharedPointer(elementType, element->semanticType)) {
-            node->elements.at(i) = std::make_shared<AstTypeConversion>(element, elementType);
+            node->elements.at(i) = makeNode<AstTypeConversion>(element, elementType);
         }
     }
 }
 
 
 void SemanticValidator::visit(std::shared_ptr<AstAssignment> node) {
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     if (node->lvalue->expr->getType() == AstNodeType::AstVariableAccess) {
         auto var = std::static_pointer_cast<AstVariableAccess>(node->lvalue->expr);
         if (isVariableDeclared(var->name)) {
@@ -660,7 +612,7 @@ void SemanticValidator::visit(std::shared_ptr<AstAssignment> node) {
             var->variable = getVariable(var->name);
             if (!isEqualTypeInSharedPointer(node->lvalue->semanticType, node->rvalue->semanticType)) {
                 // apply an automaic type conversion
-                node->rvalue = std::make_shared<AstTypeConversion>(node->rvalue, node->lvalue->semanticType);
+                node->rvalue = makeNode<AstTypeConversion>(node->rvalue, node->lvalue->semanticType);
                 node->semanticType = node->rvalue->semanticType;
             }
             else {
@@ -670,8 +622,8 @@ void SemanticValidator::visit(std::shared_ptr<AstAssignment> node) {
         else {
             hasError = true;
             Error("variable \"", var->name, "\" is not declared");
-            printErrorToken(var->token, source);
-            node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+            printErrorToken(var->token);
+            node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
         }
     }
     else if (node->lvalue->expr->getType() == AstNodeType::AstDereference) {
@@ -683,28 +635,28 @@ void SemanticValidator::visit(std::shared_ptr<AstAssignment> node) {
     else {
         hasError = true;
         Error("Unimplemented type of assignment");
-        printErrorToken(node->token, source);
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        printErrorToken(node->token);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
     }
 }
 void SemanticValidator::visit(std::shared_ptr<AstAssignLocation> node) {
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     node->semanticType = node->expr->semanticType;
 }
 void SemanticValidator::visit(std::shared_ptr<AstVariableDeclaration> node) {
     // visit the children
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     if (node->semanticType->getType() == AstNodeType::AstPrimitiveType
         && std::static_pointer_cast<AstPrimitiveType>(node->semanticType)->type == RSharpPrimitiveType::C_void) {
         hasError = true;
         Error("Variables cannot be of type c_void.");
-        printErrorToken(node->semanticType->token, source);
+        printErrorToken(node->semanticType->token);
         return;
     }
 
     if (node->value) {
         if (requireEquivalentTypes(node, node->value, "value assigned to variable of different semantical type")) {
-            node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+            node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
         }
         if (node->semanticType->getType() == AstNodeType::AstArrayType
             && node->value->semanticType->getType() == AstNodeType::AstArrayType) {
@@ -714,32 +666,33 @@ void SemanticValidator::visit(std::shared_ptr<AstVariableDeclaration> node) {
             // allow assigning sized arrays to unsized ones
             if (!self->size.has_value() && value->size.has_value()) {
                 self->size = value->size;
+                self->internedType = nullptr;
             }
 
             if (!self->size.has_value()) {
                 hasError = true;
                 Error("Unsized arrays must be assigned an array literal.");
-                printErrorToken(node->token, source);
+                printErrorToken(node->token);
                 return;
             }
         }
 
         if (!isEqualTypeInSharedPointer(node->semanticType, node->value->semanticType)) {
             // apply an automaic type conversion
-            node->value = std::make_shared<AstTypeConversion>(node->value, node->semanticType);
+            node->value = makeNode<AstTypeConversion>(node->value, node->semanticType);
         }
     }
     if (node->variable->isGlobal) {
         if (isFunctionDefined(node->name)) {
             hasError = true;
             Error("global variable \"", node->name, "\" is already declared as a function");
-            printErrorToken(node->token, source);
+            printErrorToken(node->token);
         }
 
         if (node->value && node->value->getType() == AstNodeType::AstArrayLiteral) {
-            std::queue<std::shared_ptr<AstNode>> children;
+            std::queue<AstNode*> children;
             node->value->accept(this);
-            children.push(node->value);
+            children.push(node->value.get());
             while (!children.empty()) {
                 auto child = children.front();
                 children.pop();
@@ -750,13 +703,10 @@ void SemanticValidator::visit(std::shared_ptr<AstVariableDeclaration> node) {
                     && child->getType() != AstNodeType::AstTypeConversion) {
                     hasError = true;
                     Error("expression isn't constant");
-                    printErrorToken(child->token, source);
+                    printErrorToken(child->token);
                 }
                 else {
-                    auto subchildren = child->getChildren();
-                    for (auto subchild : subchildren) {
-                        children.push(subchild);
-                    }
+                    child->forEachChild([&](AstNode* subchild) { children.push(subchild); });
                 }
             }
         }
@@ -767,20 +717,20 @@ void SemanticValidator::visit(std::shared_ptr<AstVariableDeclaration> node) {
                 node->name,
                 "\" must be initialized to a constant value (no expression)"
             );
-            printErrorToken(node->token, source);
+            printErrorToken(node->token);
         }
     }
     if (!isVariableDefinable(*node)) {
         hasError = true;
         Error("variable \"", node->name, "\" is defined multiple times");
-        printErrorToken(node->token, source);
+        printErrorToken(node->token);
     }
     else {
         addVariable(node);
     }
 }
 void SemanticValidator::visit(std::shared_ptr<AstConditionalExpression> node) {
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     requireType(node->condition);
     requireType(node->trueExpression);
     requireType(node->falseExpression);
@@ -790,21 +740,21 @@ void SemanticValidator::visit(std::shared_ptr<AstConditionalExpression> node) {
             node->trueExpression,
             "true and false ternary expressions don't match in semantic type"
         )) {
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
     }
     if (!isEqualTypeInSharedPointer(node->falseExpression->semanticType, node->trueExpression->semanticType)) {
         // apply an automaic type conversion
         node->falseExpression =
-            std::make_shared<AstTypeConversion>(node->falseExpression, node->trueExpression->semanticType);
+            makeNode<AstTypeConversion>(node->falseExpression, node->trueExpression->semanticType);
     }
 
     node->semanticType = node->trueExpression->semanticType;
 }
 void SemanticValidator::visit(std::shared_ptr<AstFunctionCall> node) {
-    auto parameters = std::make_shared<AstParameterList>();
+    auto parameters = makeNode<AstParameterList>();
     for (auto arg : node->arguments) {
         arg->accept(this);
-        parameters->parameters.push_back(std::make_shared<AstVariableDeclaration>());
+        parameters->parameters.push_back(makeNode<AstVariableDeclaration>());
         parameters->parameters.back()->semanticType = arg->semanticType;
     }
 
@@ -817,20 +767,20 @@ void SemanticValidator::visit(std::shared_ptr<AstFunctionCall> node) {
                     node->function->parameters->parameters.at(i)->semanticType
                 )) {
                 // apply an automaic type conversion
-                node->arguments.at(i) = std::make_shared<AstTypeConversion>(
+                node->arguments.at(i) = makeNode<AstTypeConversion>(
                     node->arguments.at(i),
                     node->function->parameters->parameters.at(i)->semanticType
                 );
             }
         }
 
-        AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+        visitChildren(node.get());
     }
     else {
         hasError = true;
         Error("function \"", node->name, "\" is not declared (wrong number of arguments?)");
-        printErrorToken(node->token, source);
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        printErrorToken(node->token);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
     }
 }
 
@@ -839,16 +789,16 @@ void SemanticValidator::visit(std::shared_ptr<AstAddressOf> node) {
     if (node->operand->getType() != AstNodeType::AstVariableAccess) {
         hasError = true;
         Error("Tried to get address of non-variable.\n");
-        printErrorToken(node->token, source);
-        node->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        printErrorToken(node->token);
+        node->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
     }
-    node->semanticType = std::make_shared<AstPointerType>(node->operand->semanticType);
+    node->semanticType = makeNode<AstPointerType>(node->operand->semanticType);
 }
 
 
 void SemanticValidator::visit(std::shared_ptr<AstFunctionDefinition> node) {
     // push the function context to include parameters
-    node->parameters->parameterBlock = std::make_shared<AstBlock>();
+    node->parameters->parameterBlock = makeNode<AstBlock>();
     node->parameters->parameterBlock->name = "parameters " + node->name;
     currentFunction = node;
     pushContext(node->parameters->parameterBlock);
@@ -869,12 +819,12 @@ void SemanticValidator::visit(std::shared_ptr<AstFunctionDefinition> node) {
 }
 
 void SemanticValidator::visit(std::shared_ptr<AstArrayType> node) {
-    AstVisitor::visit(std::dynamic_pointer_cast<AstNode>(node));
+    visitChildren(node.get());
     if (node->subtype->getType() == AstNodeType::AstPrimitiveType
         && std::static_pointer_cast<AstPrimitiveType>(node->subtype)->type == RSharpPrimitiveType::C_void) {
         hasError = true;
         Error("Arrays cannot contain the type c_void.");
-        printErrorToken(node->semanticType->token, source);
+        printErrorToken(node->semanticType->token);
         return;
     }
 
@@ -882,13 +832,13 @@ void SemanticValidator::visit(std::shared_ptr<AstArrayType> node) {
         if (node->size.value()->getType() != AstNodeType::AstInteger) {
             hasError = true;
             Error("Sized arrays must have a size known at compile-time (currently only integer literals).");
-            printErrorToken(node->size.value()->token, source);
+            printErrorToken(node->size.value()->token);
             return;
         }
         if (std::static_pointer_cast<AstInteger>(node->size.value())->value <= 0) {
             hasError = true;
             Error("Sized arrays must have a positive, non-zero size.");
-            printErrorToken(node->size.value()->token, source);
+            printErrorToken(node->size.value()->token);
             return;
         }
     }
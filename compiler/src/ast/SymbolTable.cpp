@@ -0,0 +1,34 @@
+#include "R-Sharp/ast/SymbolTable.hpp"
+#include "R-Sharp/Logging.hpp"
+
+void SymbolTable::pushScope() {
+    scopes.emplace_back();
+}
+void SymbolTable::popScope() {
+    for (auto name : scopes.back()) {
+        auto binding = bindings.find(name);
+        binding->second.pop_back();
+        // the key views the name of a declaration that may not outlive this scope
+        if (binding->second.empty()) bindings.erase(binding);
+    }
+    scopes.pop_back();
+}
+
+void SymbolTable::declare(std::shared_ptr<SemanticVariableData> const& variable) {
+    if (variable->name.size() == 0) Error("INTERNAL ERROR: Variable without name detected");
+
+    std::string_view name = variable->name;
+    bindings[name].push_back(Binding{.scope = scopes.size() - 1, .variable = variable});
+    scopes.back().push_back(name);
+}
+
+std::shared_ptr<SemanticVariableData> SymbolTable::lookup(std::string_view name) const {
+    auto binding = bindings.find(name);
+    if (binding == bindings.end()) return nullptr;
+    return binding->second.back().variable;
+}
+std::shared_ptr<SemanticVariableData> SymbolTable::lookupInnermost(std::string_view name) const {
+    auto binding = bindings.find(name);
+    if (binding == bindings.end() || binding->second.back().scope != scopes.size() - 1) return nullptr;
+    return binding->second.back().variable;
+}
@@ -0,0 +1,94 @@
+#include "R-Sharp/ast/TypeContext.hpp"
+
+#include <functional>
+#include <map>
+#include <stdexcept>
+
+TypeContext& TypeContext::get() {
+    static TypeContext context;
+    return context;
+}
+
+size_t TypeContext::Hash::operator()(InternedType const& type) const {
+    size_t hash = std::hash<int>()(static_cast<int>(type.kind));
+    hash = hash * 31 + std::hash<int>()(static_cast<int>(type.primitive));
+    hash = hash * 31 + std::hash<InternedType const*>()(type.subtype);
+    hash = hash * 31 + type.hasSize;
+    return hash * 31 + std::hash<int64_t>()(type.length.value_or(-1));
+}
+
+InternedType const* TypeContext::intern(AstType const& type) {
+    if (type.internedType) return type.internedType;
+
+    InternedType key{.kind = type.getType()};
+    switch (key.kind) {
+        case AstNodeType::AstPrimitiveType: {
+            key.primitive = static_cast<AstPrimitiveType const&>(type).type;
+            break;
+        }
+        case AstNodeType::AstPointerType: {
+            key.subtype = intern(*static_cast<AstPointerType const&>(type).subtype);
+            break;
+        }
+        case AstNodeType::AstArrayType: {
+            auto const& array = static_cast<AstArrayType const&>(type);
+            key.subtype = intern(*array.subtype);
+            key.hasSize = array.size.has_value();
+            if (key.hasSize && array.size.value()->getType() == AstNodeType::AstInteger)
+                key.length = std::static_pointer_cast<AstInteger>(array.size.value())->value;
+            break;
+        }
+        default: throw std::runtime_error("Unimplemented type used");
+    }
+
+    type.internedType = intern(key);
+    return type.internedType;
+}
+
+InternedType const* TypeContext::intern(InternedType type) {
+    static const std::map<RSharpPrimitiveType, int> primitive_sizes = {
+        {RSharpPrimitiveType::C_void, 1}, // should only be used for pointer arithmetic
+        {RSharpPrimitiveType::I8,     1},
+        {RSharpPrimitiveType::I16,    2},
+        {RSharpPrimitiveType::I32,    4},
+        {RSharpPrimitiveType::I64,    8},
+    };
+
+    std::lock_guard lock(mutex);
+    auto existing = types.find(type);
+    if (existing != types.end()) return &*existing;
+
+    switch (type.kind) {
+        case AstNodeType::AstPrimitiveType: {
+            auto size = primitive_sizes.find(type.primitive);
+            if (size != primitive_sizes.end()) type.size = size->second;
+            type.isErrorType = type.primitive == RSharpPrimitiveType::ErrorType;
+            break;
+        }
+        case AstNodeType::AstPointerType: {
+            type.size = 8;
+            type.isErrorType = type.subtype->isErrorType;
+            break;
+        }
+        case AstNodeType::AstArrayType: {
+            if (type.length && type.subtype->size) type.size = static_cast<int>(*type.subtype->size * *type.length);
+            type.isErrorType = type.subtype->isErrorType || (type.hasSize && !type.length);
+            break;
+        }
+        default: break;
+    }
+    return &*types.insert(type).first;
+}
+
+int TypeContext::getSize(AstType const& type) {
+    auto interned = intern(type);
+    if (interned->size) return *interned->size;
+
+    // find out why the type has no size
+    while (interned->kind == AstNodeType::AstArrayType) {
+        if (!interned->hasSize) throw std::runtime_error("Array without size during code generation.");
+        if (!interned->length) throw std::runtime_error("Array with non constant size during code generation.");
+        interned = interned->subtype;
+    }
+    throw std::runtime_error("Unimplemented type used");
+}
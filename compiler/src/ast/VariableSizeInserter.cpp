@@ -38,10 +38,7 @@ void VariableSizeInserter::visit(std::shared_ptr<AstBlock> node) {
     node->sizeOfLocalVariables = 0;
 
     scopes.push_back(node);
-    for (auto child : node->getChildren()) {
-        if (child)
-            child->accept(this);
-    }
+    visitChildren(node.get());
     scopes.pop_back();
 
     for (auto var : node->variables) {
@@ -49,7 +46,7 @@ void VariableSizeInserter::visit(std::shared_ptr<AstBlock> node) {
     }
     stackOffset -= node->sizeOfLocalVariables;
 
-    Print("Size of scope \"", node->name, "\": ", node->sizeOfLocalVariables, "\n");
+    Debug("Size of scope \"", node->name, "\": ", node->sizeOfLocalVariables, "\n");
 }
 
 
@@ -4,12 +4,11 @@
 #include "R-Sharp/Utils.hpp"
 #include "R-Sharp/ast/VariableSizeInserter.hpp"
 #include "R-Sharp/Utils/ScopeGuard.hpp"
+#include "R-Sharp/ast/TypeContext.hpp"
 
-#include <map>
 
-AArch64CodeGenerator::AArch64CodeGenerator(std::shared_ptr<AstProgram> root, std::string R_SharpSource) {
+AArch64CodeGenerator::AArch64CodeGenerator(std::shared_ptr<AstProgram> root) {
     this->root = root;
-    this->R_SharpSource = R_SharpSource;
 }
 
 void AArch64CodeGenerator::indent(AArch64CodeGenerator::BinarySection section) {
@@ -34,34 +33,7 @@ void AArch64CodeGenerator::emitIndented(std::string const& str, AArch64CodeGener
 
 
 int AArch64CodeGenerator::sizeFromSemanticalType(std::shared_ptr<AstType> type) {
-    static const std::map<RSharpPrimitiveType, int> primitive_sizes = {
-        {RSharpPrimitiveType::C_void, 1}, // should only be used for pointer arithmetic
-        {RSharpPrimitiveType::I8,     1},
-        {RSharpPrimitiveType::I16,    2},
-        {RSharpPrimitiveType::I32,    4},
-        {RSharpPrimitiveType::I64,    8},
-    };
-
-    switch (type->getType()) {
-        case AstNodeType::AstPrimitiveType: {
-            return primitive_sizes.at(std::static_pointer_cast<AstPrimitiveType>(type)->type);
-        }
-        case AstNodeType::AstPointerType: {
-            return 8;
-        }
-        case AstNodeType::AstArrayType: {
-            auto array = std::static_pointer_cast<AstArrayType>(type);
-            if (!array->size.has_value()) {
-                throw std::runtime_error("Array without size during code generation.");
-            }
-            if (array->size.value()->getType() != AstNodeType::AstInteger) {
-                throw std::runtime_error("Array with non constant size during code generation.");
-            }
-            return sizeFromSemanticalType(array->subtype)
-                 * std::static_pointer_cast<AstInteger>(array->size.value())->value;
-        }
-        default: throw std::runtime_error("Unimplemented type used");
-    }
+    return TypeContext::get().getSize(*type);
 }
 
 std::string AArch64CodeGenerator::getRegisterWithSize(int reg, int size) {
@@ -178,7 +150,7 @@ void AArch64CodeGenerator::visit(std::shared_ptr<AstProgram> node) {
         var->accessor = getUniqueLabel(var->name);
     }
 
-    for (auto const& child : node->getChildren()) {
+    for (auto const& child : node->items) {
         if (!child) continue;
         if (child->getType() == AstNodeType::AstFunctionDefinition) {
             child->accept(this);
@@ -256,9 +228,7 @@ void AArch64CodeGenerator::visit(std::shared_ptr<AstBlock> node) {
     if (!node->isMerged) setupLocalVariables(node);
 
 
-    for (auto child : node->getChildren()) {
-        if (child) child->accept(this);
-    }
+    visitChildren(node.get());
 
     // don't change stack pointer if it wasn't modified
     if (!node->isMerged) resetStackPointer(node);
@@ -438,7 +408,7 @@ void AArch64CodeGenerator::visit(std::shared_ptr<AstUnary> node) {
             break;
         default:
             Error("AArch64 Generator: Unary operator not implemented!");
-            printErrorToken(node->token, R_SharpSource);
+            printErrorToken(node->token);
             exit(1);
             break;
     }
@@ -607,7 +577,7 @@ void AArch64CodeGenerator::visit(std::shared_ptr<AstBinary> node) {
         }
         default:
             Error("AArch64 Generator: Binary operator not implemented!");
-            printErrorToken(node->token, R_SharpSource);
+            printErrorToken(node->token);
             exit(1);
             break;
     }
@@ -755,7 +725,7 @@ void AArch64CodeGenerator::visit(std::shared_ptr<AstFunctionCall> node) {
     }
     if (node->arguments.size() > 8) {
         Error("AArch64 Generator: More than 8 function arguments aren't yet supported!");
-        printErrorToken(node->arguments.at(8)->token, R_SharpSource);
+        printErrorToken(node->arguments.at(8)->token);
         exit(1);
     }
     // move arguments to registers
@@ -951,7 +921,7 @@ void AArch64CodeGenerator::visit(std::shared_ptr<AstArrayAccess> node) {
     }
     else {
         Error("NASM Generator: Unimplemented array access!");
-        printErrorToken(node->token, R_SharpSource);
+        printErrorToken(node->token);
         exit(1);
     }
 }
@@ -1012,7 +982,7 @@ void AArch64CodeGenerator::defineGlobalData(std::shared_ptr<AstExpression> node)
                 break;
             default:
                 Error("AArch64 Generator: Global variable size not supported!");
-                printErrorToken(node->token, R_SharpSource);
+                printErrorToken(node->token);
                 exit(1);
                 break;
         }
@@ -1034,7 +1004,7 @@ void AArch64CodeGenerator::defineGlobalData(std::shared_ptr<AstExpression> node)
         Error(
             "AArch64 Generator: Global variable must be an integer or array. (Found: " + node->toString() + ")"
         );
-        printErrorToken(node->token, R_SharpSource);
+        printErrorToken(node->token);
         exit(1);
     }
 }
@@ -1,8 +1,8 @@
 #include "R-Sharp/backend/CCodeGenerator.hpp"
 #include "R-Sharp/ast/AstNodes.hpp"
 #include "R-Sharp/Logging.hpp"
+#include "R-Sharp/ast/TypeContext.hpp"
 
-#include <map>
 
 CCodeGenerator::CCodeGenerator(std::shared_ptr<AstProgram> root) {
     this->root = root;
@@ -51,38 +51,10 @@ void CCodeGenerator::blockNextIndentedEmit() {
 }
 
 int CCodeGenerator::sizeFromSemanticalType(std::shared_ptr<AstType> type) {
-    static const std::map<RSharpPrimitiveType, int> primitive_sizes = {
-        {RSharpPrimitiveType::C_void, 1}, // should only be used for pointer arithmetic
-        {RSharpPrimitiveType::I8,     1},
-        {RSharpPrimitiveType::I16,    2},
-        {RSharpPrimitiveType::I32,    4},
-        {RSharpPrimitiveType::I64,    8},
-    };
-
     if (!type) {
         throw std::runtime_error("No type on node");
     }
-
-    switch (type->getType()) {
-        case AstNodeType::AstPrimitiveType: {
-            return primitive_sizes.at(std::static_pointer_cast<AstPrimitiveType>(type)->type);
-        }
-        case AstNodeType::AstPointerType: {
-            return 8;
-        }
-        case AstNodeType::AstArrayType: {
-            auto array = std::static_pointer_cast<AstArrayType>(type);
-            if (!array->size.has_value()) {
-                throw std::runtime_error("Array without size during code generation.");
-            }
-            if (array->size.value()->getType() != AstNodeType::AstInteger) {
-                throw std::runtime_error("Array with non constant size during code generation.");
-            }
-            return sizeFromSemanticalType(array->subtype)
-                 * std::static_pointer_cast<AstInteger>(array->size.value())->value;
-        }
-        default: throw std::runtime_error("Unimplemented type used");
-    }
+    return TypeContext::get().getSize(*type);
 }
 
 void CCodeGenerator::visit(std::shared_ptr<AstProgram> node) {
@@ -332,18 +304,18 @@ void CCodeGenerator::visit(std::shared_ptr<AstAssignment> node) {
         std::string rvalue_cache = getUniqueVarName("rvalue_cache");
 
         {
-            auto decl = std::make_shared<AstVariableDeclaration>();
+            auto decl = makeNode<AstVariableDeclaration>();
             decl->name = rvalue_cache;
-            decl->variable = std::make_shared<SemanticVariableData>();
+            decl->variable = makeNode<SemanticVariableData>();
             decl->variable->accessor = rvalue_cache;
             decl->variable->isDefined = true;
             decl->variable->isGlobal = false;
             decl->variable->sizeInBytes = sizeFromSemanticalType(node->rvalue->semanticType);
-            decl->semanticType = std::make_shared<AstPointerType>(node->rvalue->semanticType);
+            decl->semanticType = makeNode<AstPointerType>(node->rvalue->semanticType);
             decl->variable->type = decl->semanticType;
 
             if (node->rvalue->getType() == AstNodeType::AstArrayLiteral) {
-                auto tmp = std::make_shared<AstAddressOf>();
+                auto tmp = makeNode<AstAddressOf>();
                 tmp->operand = node->rvalue;
                 tmp->semanticType = decl->semanticType;
                 decl->value = tmp;
@@ -0,0 +1,195 @@
+#include "R-Sharp/backend/ElfObjectWriter.hpp"
+#include "R-Sharp/Logging.hpp"
+
+#include <algorithm>
+#include <array>
+#include <elf.h>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+enum SectionIndex : uint16_t {
+    NullSection,
+    Text,
+    Data,
+    Bss,
+    RelaText,
+    Symtab,
+    Strtab,
+    Shstrtab,
+    NoteGnuStack,
+    SectionCount,
+};
+
+// names separated by null characters, starting with the empty name
+class StringTable {
+public:
+    uint32_t add(std::string_view name) {
+        uint32_t offset = contents.size();
+        contents.append(name);
+        contents.push_back('\0');
+        return offset;
+    }
+    std::string const& getContents() const {
+        return contents;
+    }
+
+private:
+    std::string contents = std::string(1, '\0');
+};
+
+// pads the buffer to the alignment, returns the new size
+size_t align(std::string& buffer, size_t alignment) {
+    buffer.resize((buffer.size() + alignment - 1) / alignment * alignment, '\0');
+    return buffer.size();
+}
+
+template <typename T>
+void append(std::string& buffer, T const& value) {
+    buffer.append(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+} // namespace
+
+void ElfObjectWriter::addGlobal(std::string_view label) {
+    globals.push_back(label);
+}
+void ElfObjectWriter::addExtern(std::string_view name) {
+    externs.push_back(name);
+}
+void ElfObjectWriter::addVariable(std::string_view name, int64_t value) {
+    variables.push_back(Variable{.name = name, .value = value});
+}
+void ElfObjectWriter::addUninitializedVariable(std::string_view name, size_t size) {
+    uninitializedVariables.push_back(UninitializedVariable{.name = name, .size = size});
+}
+
+std::optional<std::string> ElfObjectWriter::write() const {
+    StringTable symbolNames;
+    std::vector<Elf64_Sym> symbols(1, Elf64_Sym{});
+    std::unordered_map<std::string_view, uint32_t> symbolIndices;
+    const auto addSymbol = [&](std::string_view name, unsigned char binding, unsigned char type, uint16_t section,
+                               uint64_t value, uint64_t size) {
+        symbolIndices[name] = symbols.size();
+        symbols.push_back(Elf64_Sym{
+            .st_name = symbolNames.add(name),
+            .st_info = static_cast<unsigned char>(ELF64_ST_INFO(binding, type)),
+            .st_other = STV_DEFAULT,
+            .st_shndx = section,
+            .st_value = value,
+            .st_size = size,
+        });
+    };
+
+    // all local symbols have to come before the global ones, sorted by offset for a stable output
+    std::unordered_set<std::string_view> globalNames(globals.begin(), globals.end());
+    std::vector<std::pair<std::string_view, size_t>> labels(text.getLabels().begin(), text.getLabels().end());
+    std::sort(labels.begin(), labels.end(), [](auto const& a, auto const& b) {
+        return std::tie(a.second, a.first) < std::tie(b.second, b.first);
+    });
+    for (auto const& [name, offset] : labels) {
+        if (!globalNames.count(name)) addSymbol(name, STB_LOCAL, STT_NOTYPE, Text, offset, 0);
+    }
+    std::string data;
+    for (auto const& variable : variables) {
+        addSymbol(variable.name, STB_LOCAL, STT_OBJECT, Data, data.size(), sizeof(int64_t));
+        append(data, variable.value);
+    }
+    size_t bssSize = 0;
+    for (auto const& variable : uninitializedVariables) {
+        addSymbol(variable.name, STB_LOCAL, STT_OBJECT, Bss, bssSize, variable.size);
+        bssSize += variable.size;
+    }
+
+    uint32_t firstGlobal = symbols.size();
+    for (auto name : globals) {
+        // like NASM, a global that isn't defined here refers to another object
+        auto label = text.getLabels().find(name);
+        if (label == text.getLabels().end()) addSymbol(name, STB_GLOBAL, STT_NOTYPE, SHN_UNDEF, 0, 0);
+        else addSymbol(name, STB_GLOBAL, STT_FUNC, Text, label->second, 0);
+    }
+    for (auto name : externs) {
+        addSymbol(name, STB_GLOBAL, STT_NOTYPE, SHN_UNDEF, 0, 0);
+    }
+
+    std::vector<Elf64_Rela> relocations;
+    relocations.reserve(text.getRelocations().size());
+    for (auto const& relocation : text.getRelocations()) {
+        auto symbol = symbolIndices.find(relocation.symbol);
+        if (symbol == symbolIndices.end()) {
+            Error("Undefined symbol \"", relocation.symbol, "\"");
+            return std::nullopt;
+        }
+        relocations.push_back(Elf64_Rela{
+            .r_offset = relocation.offset,
+            .r_info = ELF64_R_INFO(symbol->second, relocation.type),
+            .r_addend = relocation.addend,
+        });
+    }
+
+    // the header is filled in last, when the offset of the section headers is known
+    std::string file(sizeof(Elf64_Ehdr), '\0');
+    std::array<Elf64_Shdr, SectionCount> sections{};
+    StringTable sectionNames;
+    constexpr std::array<std::string_view, SectionCount> names = {
+        "", ".text", ".data", ".bss", ".rela.text", ".symtab", ".strtab", ".shstrtab", ".note.GNU-stack",
+    };
+    for (size_t i = Text; i < SectionCount; i++)
+        sections[i].sh_name = sectionNames.add(names[i]);
+
+    const auto addSection = [&](SectionIndex index, uint32_t type, uint64_t flags, uint64_t alignment,
+                                std::string_view contents) -> Elf64_Shdr& {
+        auto& section = sections[index];
+        section.sh_type = type;
+        section.sh_flags = flags;
+        section.sh_addralign = alignment;
+        section.sh_offset = align(file, alignment);
+        section.sh_size = contents.size();
+        file.append(contents);
+        return section;
+    };
+    const auto view = [](auto const& values) {
+        return std::string_view(
+            reinterpret_cast<char const*>(values.data()), values.size() * sizeof(*values.data())
+        );
+    };
+
+    addSection(Text, SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR, 16, view(text.getCode()));
+    addSection(Data, SHT_PROGBITS, SHF_ALLOC | SHF_WRITE, 8, data);
+    addSection(Bss, SHT_NOBITS, SHF_ALLOC | SHF_WRITE, 8, "").sh_size = bssSize;
+
+    auto& relaText = addSection(RelaText, SHT_RELA, SHF_INFO_LINK, 8, view(relocations));
+    relaText.sh_link = Symtab;
+    relaText.sh_info = Text;
+    relaText.sh_entsize = sizeof(Elf64_Rela);
+
+    auto& symtab = addSection(Symtab, SHT_SYMTAB, 0, 8, view(symbols));
+    symtab.sh_link = Strtab;
+    symtab.sh_info = firstGlobal;
+    symtab.sh_entsize = sizeof(Elf64_Sym);
+
+    addSection(Strtab, SHT_STRTAB, 0, 1, symbolNames.getContents());
+    // the stack doesn't need to be executable
+    addSection(NoteGnuStack, SHT_PROGBITS, 0, 1, "");
+    addSection(Shstrtab, SHT_STRTAB, 0, 1, sectionNames.getContents());
+
+    Elf64_Ehdr header{};
+    std::copy_n(ELFMAG, SELFMAG, header.e_ident);
+    header.e_ident[EI_CLASS] = ELFCLASS64;
+    header.e_ident[EI_DATA] = ELFDATA2LSB;
+    header.e_ident[EI_VERSION] = EV_CURRENT;
+    header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    header.e_type = ET_REL;
+    header.e_machine = EM_X86_64;
+    header.e_version = EV_CURRENT;
+    header.e_shoff = align(file, 8);
+    header.e_ehsize = sizeof(Elf64_Ehdr);
+    header.e_shentsize = sizeof(Elf64_Shdr);
+    header.e_shnum = SectionCount;
+    header.e_shstrndx = Shstrtab;
+    file.replace(0, sizeof(Elf64_Ehdr), reinterpret_cast<char const*>(&header), sizeof(Elf64_Ehdr));
+
+    for (auto const& section : sections)
+        append(file, section);
+    return file;
+}
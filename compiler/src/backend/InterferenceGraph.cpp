@@ -0,0 +1,168 @@
+#include "R-Sharp/backend/InterferenceGraph.hpp"
+#include "R-Sharp/backend/RSI.hpp"
+
+#include <utility>
+#include <algorithm>
+#include <queue>
+
+namespace RSI {
+
+InterferenceGraph::InterferenceGraph(size_t numVertices)
+    : matrix(numVertices * (numVertices + 1) / 2), adjacency(numVertices) {}
+
+size_t InterferenceGraph::matrixIndex(size_t a, size_t b) {
+    if (a < b) std::swap(a, b);
+    return a * (a + 1) / 2 + b;
+}
+
+bool InterferenceGraph::addEdge(size_t a, size_t b) {
+    if (a == b) return false;
+
+    auto index = matrixIndex(a, b);
+    if (matrix.test(index)) return false;
+
+    matrix.set(index);
+    adjacency.at(a).push_back(b);
+    adjacency.at(b).push_back(a);
+    return true;
+}
+
+bool InterferenceGraph::interferes(size_t a, size_t b) const {
+    return matrix.test(matrixIndex(a, b));
+}
+
+InterferenceGraph buildInterferenceGraph(Function const& function) {
+    InterferenceGraph graph(function.meta.referencesByIndex.size());
+
+    auto const& instructions = function.instructions;
+    for (size_t i = 0; i + 1 < instructions.size(); i++) {
+        auto const& instr = instructions.at(i);
+        if (!std::holds_alternative<std::shared_ptr<Reference>>(instr.result)) continue;
+
+        auto defined = std::get<std::shared_ptr<Reference>>(instr.result)->index;
+        instructions.at(i + 1).meta.liveVariablesBefore.forEach([&](size_t live) {
+            graph.addEdge(defined, live);
+        });
+    }
+
+    return graph;
+}
+
+std::vector<Color> colorInterferenceGraph(
+    InterferenceGraph const& graph,
+    std::vector<std::optional<Color>> const& precolored,
+    std::vector<double> const& spillCosts,
+    size_t numColors
+) {
+    const size_t numVertices = graph.size();
+    std::vector<Color> colors(numVertices, spilledColor);
+
+    const auto constrainsColoring = [&](size_t vertex) {
+        return !precolored.at(vertex).has_value() || precolored.at(vertex).value() < numColors;
+    };
+
+    // degree only counts the neighbours which can take away a color
+    std::vector<size_t> degree(numVertices, 0);
+    std::vector<bool> isRemoved(numVertices, false);
+    size_t maxDegree = 0;
+    for (size_t v = 0; v < numVertices; v++) {
+        if (precolored.at(v).has_value()) {
+            colors.at(v) = precolored.at(v).value();
+            isRemoved.at(v) = true;
+            continue;
+        }
+        for (auto neighbour : graph.neighbours(v)) {
+            if (constrainsColoring(neighbour)) degree.at(v)++;
+        }
+        maxDegree = std::max(maxDegree, degree.at(v));
+    }
+
+    // vertices are bucketed by degree; stale entries are skipped when popped
+    std::vector<std::vector<size_t>> buckets(maxDegree + 1);
+    size_t remaining = 0;
+    for (size_t v = numVertices; v-- > 0;) {
+        if (isRemoved.at(v)) continue;
+        buckets.at(degree.at(v)).push_back(v);
+        remaining++;
+    }
+
+    const auto popFromBucket = [&](size_t bucket) -> std::optional<size_t> {
+        while (!buckets.at(bucket).empty()) {
+            auto v = buckets.at(bucket).back();
+            buckets.at(bucket).pop_back();
+            if (!isRemoved.at(v) && degree.at(v) == bucket) return v;
+        }
+        return std::nullopt;
+    };
+
+    // spill candidates ordered by cost per degree, entries with an outdated degree are skipped as well
+    struct SpillCandidate {
+        double priority;
+        size_t degree;
+        size_t vertex;
+
+        bool operator<(SpillCandidate const& other) const {
+            if (priority != other.priority) return priority > other.priority;
+            return vertex > other.vertex;
+        }
+    };
+    std::priority_queue<SpillCandidate> spillCandidates;
+    const auto pushSpillCandidate = [&](size_t v) {
+        if (degree.at(v) >= numColors)
+            spillCandidates.push({spillCosts.at(v) / degree.at(v), degree.at(v), v});
+    };
+    for (size_t v = 0; v < numVertices; v++) {
+        if (!isRemoved.at(v)) pushSpillCandidate(v);
+    }
+
+    // simplify
+    std::vector<size_t> selectStack;
+    selectStack.reserve(remaining);
+    size_t lowestBucket = 0;
+    while (remaining) {
+        std::optional<size_t> next;
+        for (; !next.has_value() && lowestBucket < std::min(numColors, buckets.size()); lowestBucket++) {
+            next = popFromBucket(lowestBucket);
+            if (next.has_value()) break;
+        }
+        // no trivially colorable vertex is left, push the cheapest one to spill optimistically
+        while (!next.has_value()) {
+            auto candidate = spillCandidates.top();
+            spillCandidates.pop();
+            if (!isRemoved.at(candidate.vertex) && degree.at(candidate.vertex) == candidate.degree)
+                next = candidate.vertex;
+        }
+
+        auto v = next.value();
+        isRemoved.at(v) = true;
+        remaining--;
+        selectStack.push_back(v);
+
+        for (auto neighbour : graph.neighbours(v)) {
+            if (isRemoved.at(neighbour)) continue;
+            auto& d = degree.at(neighbour);
+            d--;
+            buckets.at(d).push_back(neighbour);
+            pushSpillCandidate(neighbour);
+            lowestBucket = std::min(lowestBucket, d);
+        }
+    }
+
+    // select
+    std::vector<bool> isColorUsed(numColors);
+    while (!selectStack.empty()) {
+        auto v = selectStack.back();
+        selectStack.pop_back();
+
+        std::fill(isColorUsed.begin(), isColorUsed.end(), false);
+        for (auto neighbour : graph.neighbours(v)) {
+            if (colors.at(neighbour) < numColors) isColorUsed.at(colors.at(neighbour)) = true;
+        }
+        auto freeColor = std::find(isColorUsed.begin(), isColorUsed.end(), false);
+        if (freeColor != isColorUsed.end()) colors.at(v) = freeColor - isColorUsed.begin();
+    }
+
+    return colors;
+}
+
+}
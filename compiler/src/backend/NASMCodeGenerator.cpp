@@ -5,13 +5,13 @@
 #include "R-Sharp/ast/AstNodesFWD.hpp"
 #include "R-Sharp/ast/VariableSizeInserter.hpp"
 #include "R-Sharp/Utils/ScopeGuard.hpp"
+#include "R-Sharp/ast/TypeContext.hpp"
 
 #include <map>
 #include <math.h>
 
-NASMCodeGenerator::NASMCodeGenerator(std::shared_ptr<AstProgram> root, std::string R_SharpSource) {
+NASMCodeGenerator::NASMCodeGenerator(std::shared_ptr<AstProgram> root) {
     this->root = root;
-    this->R_SharpSource = R_SharpSource;
 }
 
 void NASMCodeGenerator::indent(NASMCodeGenerator::BinarySection section) {
@@ -34,34 +34,7 @@ void NASMCodeGenerator::emitIndented(std::string const& str, NASMCodeGenerator::
 }
 
 int NASMCodeGenerator::sizeFromSemanticalType(std::shared_ptr<AstType> type) {
-    static const std::map<RSharpPrimitiveType, int> primitive_sizes = {
-        {RSharpPrimitiveType::C_void, 1}, // should only be used for pointer arithmetic
-        {RSharpPrimitiveType::I8,     1},
-        {RSharpPrimitiveType::I16,    2},
-        {RSharpPrimitiveType::I32,    4},
-        {RSharpPrimitiveType::I64,    8},
-    };
-
-    switch (type->getType()) {
-        case AstNodeType::AstPrimitiveType: {
-            return primitive_sizes.at(std::static_pointer_cast<AstPrimitiveType>(type)->type);
-        }
-        case AstNodeType::AstPointerType: {
-            return 8;
-        }
-        case AstNodeType::AstArrayType: {
-            auto array = std::static_pointer_cast<AstArrayType>(type);
-            if (!array->size.has_value()) {
-                throw std::runtime_error("Array without size during code generation.");
-            }
-            if (array->size.value()->getType() != AstNodeType::AstInteger) {
-                throw std::runtime_error("Array with non constant size during code generation.");
-            }
-            return sizeFromSemanticalType(array->subtype)
-                 * std::static_pointer_cast<AstInteger>(array->size.value())->value;
-        }
-        default: throw std::runtime_error("Unimplemented type used");
-    }
+    return TypeContext::get().getSize(*type);
 }
 
 std::string NASMCodeGenerator::generate() {
@@ -344,7 +317,7 @@ void NASMCodeGenerator::visit(std::shared_ptr<AstProgram> node) {
         var->accessor = getUniqueLabel(var->name);
     }
 
-    for (auto const& child : node->getChildren()) {
+    for (auto const& child : node->items) {
         if (!child)
             continue;
         if (child->getType() == AstNodeType::AstFunctionDefinition) {
@@ -430,10 +403,7 @@ void NASMCodeGenerator::visit(std::shared_ptr<AstBlock> node) {
     if (!node->isMerged)
         setupLocalVariables(node);
 
-    for (auto child : node->getChildren()) {
-        if (child)
-            child->accept(this);
-    }
+    visitChildren(node.get());
 
     // don't change stack pointer if it wasn't modified
     if (!node->isMerged)
@@ -621,7 +591,7 @@ void NASMCodeGenerator::visit(std::shared_ptr<AstUnary> node) {
             break;
         default:
             Error("NASM Generator: Unary operator not implemented!");
-            printErrorToken(node->token, R_SharpSource);
+            printErrorToken(node->token);
             exit(1);
             break;
     }
@@ -827,7 +797,7 @@ void NASMCodeGenerator::visit(std::shared_ptr<AstBinary> node) {
         }
         default:
             Error("NASM Generator: Binary operator not implemented!");
-            printErrorToken(node->token, R_SharpSource);
+            printErrorToken(node->token);
             exit(1);
             break;
     }
@@ -915,7 +885,7 @@ void NASMCodeGenerator::visit(std::shared_ptr<AstFunctionCall> node) {
 
     if (node->arguments.size() > 6) {
         Error("NASM Generator: More than 6 parameters are not supported yet!");
-        printErrorToken(node->token, R_SharpSource);
+        printErrorToken(node->token);
         exit(1);
     }
     // save registers
@@ -1125,7 +1095,7 @@ void NASMCodeGenerator::visit(std::shared_ptr<AstArrayAccess> node) {
     }
     else {
         Error("NASM Generator: Unimplemented array access!");
-        printErrorToken(node->token, R_SharpSource);
+        printErrorToken(node->token);
         exit(1);
     }
 }
@@ -1186,7 +1156,7 @@ void NASMCodeGenerator::defineGlobalData(std::shared_ptr<AstExpression> node) {
             case 8: emitIndented("dq " + std::to_string(intNode->value) + "\n", BinarySection::Data); break;
             default:
                 Error("NASM Generator: Global variable size not supported!");
-                printErrorToken(node->token, R_SharpSource);
+                printErrorToken(node->token);
                 exit(1);
                 break;
         }
@@ -1207,7 +1177,7 @@ void NASMCodeGenerator::defineGlobalData(std::shared_ptr<AstExpression> node) {
     }
     else {
         Error("NASM Generator: Global variable must be an integer or array. (Found: " + node->toString() + ")");
-        printErrorToken(node->token, R_SharpSource);
+        printErrorToken(node->token);
         exit(1);
     }
 }
@@ -1284,7 +1254,7 @@ void NASMCodeGenerator::visit(std::shared_ptr<AstVariableDeclaration> node) {
                         "NASM Generator: Unsupported variable size " + std::to_string(node->variable->sizeInBytes)
                         + " for variable '" + node->variable->name + "'"
                     );
-                    printErrorToken(node->token, R_SharpSource);
+                    printErrorToken(node->token);
                     exit(1);
             }
         }
@@ -1,175 +1,495 @@
 #include "R-Sharp/backend/RSIAnalysis.hpp"
 #include "R-Sharp/backend/RSIGenerator.hpp"
-#include "R-Sharp/backend/Graph.hpp"
+#include "R-Sharp/backend/RSIControlFlow.hpp"
+#include "R-Sharp/backend/InterferenceGraph.hpp"
 #include "R-Sharp/backend/Architecture.hpp"
 #include "R-Sharp/Utils/ContainerTools.hpp"
+#include "R-Sharp/Logging.hpp"
 
-#include "R-Sharp/Utils/ScopeGuard.hpp"
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
 
 
 namespace RSI {
 
 void analyzeLiveVariables(RSI::Function& function, Architecture const&) {
-    bool hasModifiedTheIR = true;
-
-    const auto setSizeWatchGuard = [&hasModifiedTheIR](auto const& setToWatch) {
-        const auto sizeAtBeginning = setToWatch.size();
-        return ScopeGuard([&setToWatch, sizeAtBeginning, &hasModifiedTheIR]() {
-            if (sizeAtBeginning != setToWatch.size()) {
-                hasModifiedTheIR = true;
-            }
-        });
+    // give every reference a dense index, so the live sets can be stored as bitsets
+    auto& references = function.meta.referencesByIndex;
+    references.clear();
+    std::set<std::shared_ptr<RSI::Reference>> seen;
+    const auto indexReference = [&](Operand const& op) {
+        if (!std::holds_alternative<std::shared_ptr<RSI::Reference>>(op)) return;
+        auto ref = std::get<std::shared_ptr<RSI::Reference>>(op);
+        if (!seen.insert(ref).second) return;
+        ref->index = references.size();
+        references.push_back(ref);
     };
+    for (auto const& instr : function.instructions) {
+        indexReference(instr.result);
+        indexReference(instr.op1);
+        indexReference(instr.op2);
+    }
 
-    Instruction virtualEndInstruction{
-        .type = InstructionType::NOP,
+    const auto cfg = buildControlFlowGraph(function);
+    const DynamicBitset emptySet(references.size());
+
+    const auto applyInstruction = [](DynamicBitset& live, Instruction const& instr) {
+        if (std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.result)) {
+            live.reset(std::get<std::shared_ptr<RSI::Reference>>(instr.result)->index);
+        }
+        if (std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.op1)) {
+            live.set(std::get<std::shared_ptr<RSI::Reference>>(instr.op1)->index);
+        }
+        if (std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.op2)) {
+            live.set(std::get<std::shared_ptr<RSI::Reference>>(instr.op2)->index);
+        }
     };
-    while (hasModifiedTheIR) {
-        hasModifiedTheIR = false;
-
-        Instruction* lastInstruction = &virtualEndInstruction;
-        for (auto it = function.instructions.rbegin(); it != function.instructions.rend(); it++) {
-            auto& instr = *it;
-            const auto liveVariableBeforeThisPass = instr.meta.liveVariablesBefore;
-
-            if (lastInstruction->meta.liveVariablesBefore.size() != 0) {
-                instr.meta.liveVariablesBefore.insert(
-                    lastInstruction->meta.liveVariablesBefore.begin(),
-                    lastInstruction->meta.liveVariablesBefore.end()
-                );
-            }
 
+    // summarize every block as the variables it reads before writing them (gen) and the ones it writes (kill)
+    std::vector<DynamicBitset> gen(cfg.blocks.size(), emptySet), kill(cfg.blocks.size(), emptySet);
+    for (size_t b = 0; b < cfg.blocks.size(); b++) {
+        auto const& block = cfg.blocks.at(b);
+        for (size_t i = block.end; i-- > block.begin;) {
+            auto const& instr = function.instructions.at(i);
             if (std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.result)) {
-                instr.meta.liveVariablesBefore.erase(std::get<std::shared_ptr<RSI::Reference>>(instr.result));
+                kill.at(b).set(std::get<std::shared_ptr<RSI::Reference>>(instr.result)->index);
             }
+            applyInstruction(gen.at(b), instr);
+        }
+    }
+
+    std::vector<DynamicBitset> liveIn(cfg.blocks.size(), emptySet), liveOut(cfg.blocks.size(), emptySet);
+
+    // blocks are pushed in program order, so the last block gets processed first
+    std::vector<size_t> worklist;
+    std::vector<bool> isQueued(cfg.blocks.size(), true);
+    worklist.reserve(cfg.blocks.size());
+    for (size_t b = 0; b < cfg.blocks.size(); b++) {
+        worklist.push_back(b);
+    }
 
-            if (std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.op1)) {
-                instr.meta.liveVariablesBefore.insert(std::get<std::shared_ptr<RSI::Reference>>(instr.op1));
+    DynamicBitset in;
+    while (!worklist.empty()) {
+        const size_t b = worklist.back();
+        worklist.pop_back();
+        isQueued.at(b) = false;
+
+        auto& out = liveOut.at(b);
+        for (auto succ : cfg.blocks.at(b).successors) {
+            out |= liveIn.at(succ);
+        }
+
+        in = out;
+        in -= kill.at(b);
+        in |= gen.at(b);
+
+        if (in == liveIn.at(b)) continue;
+        std::swap(liveIn.at(b), in);
+
+        for (auto pred : cfg.blocks.at(b).predecessors) {
+            if (!isQueued.at(pred)) {
+                isQueued.at(pred) = true;
+                worklist.push_back(pred);
             }
-            if (std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.op2)) {
-                instr.meta.liveVariablesBefore.insert(std::get<std::shared_ptr<RSI::Reference>>(instr.op2));
+        }
+    }
+
+    // expand the block results back onto the individual instructions
+    for (size_t b = 0; b < cfg.blocks.size(); b++) {
+        auto const& block = cfg.blocks.at(b);
+        DynamicBitset live = liveOut.at(b);
+        for (size_t i = block.end; i-- > block.begin;) {
+            auto& instr = function.instructions.at(i);
+            applyInstruction(live, instr);
+            instr.meta.liveVariablesBefore = live;
+        }
+    }
+}
+
+// the general purpose registers are the assignable colors, the stack pointer gets the one after them
+static std::map<RSI::HWRegister, Color> getRegisterColors(Architecture const& arch) {
+    std::map<RSI::HWRegister, Color> HWRegisterToColor;
+    for (Color i = 0; i < arch.generalPurposeRegisters.size(); i++) {
+        HWRegisterToColor.insert({arch.generalPurposeRegisters.at(i), i});
+    }
+    HWRegisterToColor.insert({arch.stackPointerRegister, arch.generalPurposeRegisters.size()});
+    return HWRegisterToColor;
+}
+
+// keep the color/register
+static std::vector<std::optional<Color>> getPrecoloring(
+    Function const& func, std::map<RSI::HWRegister, Color> const& HWRegisterToColor
+) {
+    auto const& references = func.meta.referencesByIndex;
+    std::vector<std::optional<Color>> precolored(references.size());
+    for (size_t i = 0; i < references.size(); i++) {
+        auto const& location = references.at(i)->storageLocation;
+        if (std::holds_alternative<RSI::HWRegister>(location)) {
+            precolored.at(i) = HWRegisterToColor.at(std::get<RSI::HWRegister>(location));
+        }
+        if (std::holds_alternative<RSI::StackSlot>(location)) {
+            precolored.at(i) = spilledColor;
+        }
+    }
+    return precolored;
+}
+
+/*
+Merge the references on both sides of a MOVE if that can't make the graph harder to color,
+and delete the moves that became `mov x, x`.
+
+Two free references are merged if the result has less than k neighbours of significant degree
+(Briggs). A free reference is merged into one pinned to a register if every neighbour of it
+either has insignificant degree or already interferes with the pinned one (George).
+
+Each reference is merged at most once per round, afterwards the code is rewritten and
+analyzed again, until nothing changes anymore.
+*/
+static uint64_t coalesceMoves(Function& func, Architecture const& arch) {
+    const auto HWRegisterToColor = getRegisterColors(arch);
+    const size_t numColors = arch.generalPurposeRegisters.size();
+    uint64_t removedMoves = 0;
+
+    while (true) {
+        auto const& references = func.meta.referencesByIndex;
+        const auto graph = buildInterferenceGraph(func);
+        const auto precolored = getPrecoloring(func, HWRegisterToColor);
+
+        const auto isSignificant = [&](size_t vertex, size_t degree) {
+            if (!precolored.at(vertex).has_value()) return degree >= numColors;
+            return precolored.at(vertex).value() < numColors;
+        };
+
+        const auto briggs = [&](size_t a, size_t b) {
+            size_t significantNeighbours = 0;
+            for (auto t : graph.neighbours(a)) {
+                if (isSignificant(t, graph.degree(t) - (graph.interferes(t, b) ? 1 : 0))) significantNeighbours++;
             }
+            for (auto t : graph.neighbours(b)) {
+                if (!graph.interferes(t, a) && isSignificant(t, graph.degree(t))) significantNeighbours++;
+            }
+            return significantNeighbours < numColors;
+        };
 
-            if (instr.type == RSI::InstructionType::DEFINE_LABEL) {
-                for (auto& jump_instr : function.instructions) {
-                    if (jump_instr.type != RSI::InstructionType::JUMP && jump_instr.type != RSI::InstructionType::JUMP_IF_ZERO)
-                        continue;
-
-                    if (jump_instr.op1 == instr.op1 || jump_instr.op2 == instr.op1) {
-                        const auto guard = setSizeWatchGuard(jump_instr.meta.liveVariablesBefore);
-                        jump_instr.meta.liveVariablesBefore.insert(
-                            instr.meta.liveVariablesBefore.begin(),
-                            instr.meta.liveVariablesBefore.end()
-                        );
-                    }
+        const auto george = [&](size_t free, size_t pinned) {
+            for (auto t : graph.neighbours(free)) {
+                if (precolored.at(t).has_value()) {
+                    if (precolored.at(t) == precolored.at(pinned)) return false;
+                    continue;
                 }
+                if (graph.degree(t) >= numColors && !graph.interferes(t, pinned)) return false;
             }
+            return true;
+        };
+
+        std::vector<size_t> replacement(references.size());
+        std::iota(replacement.begin(), replacement.end(), 0);
+        std::vector<bool> isMerged(references.size(), false);
+        bool changed = false;
 
-            if (liveVariableBeforeThisPass != instr.meta.liveVariablesBefore) {
-                hasModifiedTheIR = true;
+        for (auto const& instr : func.instructions) {
+            if (instr.type != InstructionType::MOVE || !std::holds_alternative<std::shared_ptr<Reference>>(instr.result)
+                || !std::holds_alternative<std::shared_ptr<Reference>>(instr.op1))
+                continue;
+
+            auto a = std::get<std::shared_ptr<Reference>>(instr.result)->index;
+            auto b = std::get<std::shared_ptr<Reference>>(instr.op1)->index;
+            if (a == b || isMerged.at(a) || isMerged.at(b) || graph.interferes(a, b)) continue;
+
+            // references on the stack or in the stack pointer stay where they are
+            if (precolored.at(a).has_value() && precolored.at(a).value() >= numColors) continue;
+            if (precolored.at(b).has_value() && precolored.at(b).value() >= numColors) continue;
+
+            if (precolored.at(b).has_value()) std::swap(a, b);
+            // a is now the pinned one if there is any
+            if (precolored.at(a).has_value() && precolored.at(b).has_value()) {
+                if (precolored.at(a) != precolored.at(b)) continue;
+            }
+            else if (precolored.at(a).has_value()) {
+                if (!george(b, a)) continue;
             }
+            else if (!briggs(a, b)) {
+                continue;
+            }
+
+            replacement.at(b) = a;
+            isMerged.at(a) = isMerged.at(b) = true;
+            changed = true;
+        }
+
+        const auto replace = [&](Operand& op) {
+            if (std::holds_alternative<std::shared_ptr<Reference>>(op)) {
+                op = references.at(replacement.at(std::get<std::shared_ptr<Reference>>(op)->index));
+            }
+        };
+        for (auto& instr : func.instructions) {
+            replace(instr.result);
+            replace(instr.op1);
+            replace(instr.op2);
+        }
+
+        auto redundantMoves = std::remove_if(func.instructions.begin(), func.instructions.end(), [](auto const& instr) {
+            return instr.type == InstructionType::MOVE && std::holds_alternative<std::shared_ptr<Reference>>(instr.result)
+                && instr.result == instr.op1;
+        });
+        auto removed = std::distance(redundantMoves, func.instructions.end());
+        func.instructions.erase(redundantMoves, func.instructions.end());
+        removedMoves += removed;
 
-            lastInstruction = &*it;
+        if (!changed && removed == 0) break;
+        analyzeLiveVariables(func, arch);
+    }
+
+    return removedMoves;
+}
+
+/*
+Estimate how expensive it is to keep each reference in memory: every use or definition costs 10^(loop depth).
+
+Loops are found as backward jumps in the instruction stream, every instruction between a label and a
+jump back to it is one level deeper.
+*/
+static std::vector<double> computeSpillCosts(Function const& func) {
+    auto const& instructions = func.instructions;
+
+    std::unordered_map<Label const*, size_t> labelPositions;
+    for (size_t i = 0; i < instructions.size(); i++) {
+        if (instructions.at(i).type == InstructionType::DEFINE_LABEL)
+            labelPositions.insert({std::get<std::shared_ptr<Label>>(instructions.at(i).op1).get(), i});
+    }
+
+    // difference array of the loop depth
+    std::vector<int64_t> depthChange(instructions.size() + 1, 0);
+    for (size_t i = 0; i < instructions.size(); i++) {
+        auto const& instr = instructions.at(i);
+        Operand const* target = nullptr;
+        if (instr.type == InstructionType::JUMP) target = &instr.op1;
+        if (instr.type == InstructionType::JUMP_IF_ZERO) target = &instr.op2;
+        if (target == nullptr) continue;
+
+        auto label = labelPositions.find(std::get<std::shared_ptr<Label>>(*target).get());
+        if (label != labelPositions.end() && label->second < i) {
+            depthChange.at(label->second)++;
+            depthChange.at(i + 1)--;
         }
-        Print("LVA Pass");
     }
+
+    std::vector<double> costs(func.meta.referencesByIndex.size(), 0);
+    int64_t depth = 0;
+    for (size_t i = 0; i < instructions.size(); i++) {
+        depth += depthChange.at(i);
+        const double weight = std::pow(10.0, depth);
+
+        auto const& instr = instructions.at(i);
+        for (auto const* op : {&instr.result, &instr.op1, &instr.op2}) {
+            if (std::holds_alternative<std::shared_ptr<Reference>>(*op))
+                costs.at(std::get<std::shared_ptr<Reference>>(*op)->index) += weight;
+        }
+    }
+    return costs;
 }
 
 void assignRegistersGraphColoring(Function& func, Architecture const& arch) {
-    Graph<void> interferenceGraph;
-    using Vertex = Vertex<void>;
+    func.meta.coalescedMoves = coalesceMoves(func, arch);
+    Debug("Removed ", func.meta.coalescedMoves, " moves from \"", func.name, "\" by coalescing.");
+
+    auto const& references = func.meta.referencesByIndex;
+    const auto interferenceGraph = buildInterferenceGraph(func);
+    const auto precolored = getPrecoloring(func, getRegisterColors(arch));
+    const Color stackPointerColor = arch.generalPurposeRegisters.size();
 
-    auto allAssignableColors = VertexColor::getNColors(arch.generalPurposeRegisters.size());
-    auto stackPointerColor = VertexColor();
-    auto allAvailableColors = allAssignableColors;
-    allAvailableColors.push_back(stackPointerColor);
+    auto colors = colorInterferenceGraph(
+        interferenceGraph, precolored, computeSpillCosts(func), arch.generalPurposeRegisters.size()
+    );
 
-    std::map<VertexColor, RSI::HWRegister> colorToHWRegister;
-    std::map<RSI::HWRegister, VertexColor> HWRegisterToColor;
+    // spilled references that don't interfere can share a stack slot, which is a second coloring with unlimited colors
+    constexpr size_t noSlot = std::numeric_limits<size_t>::max();
+    std::vector<size_t> spillSlots(references.size(), noSlot);
+    size_t numSpillSlots = 0;
+    std::vector<bool> isSlotUsed;
+    for (size_t i = 0; i < references.size(); i++) {
+        if (colors.at(i) != spilledColor || precolored.at(i).has_value()) continue;
+
+        isSlotUsed.assign(numSpillSlots + 1, false);
+        for (auto neighbour : interferenceGraph.neighbours(i)) {
+            if (spillSlots.at(neighbour) != noSlot) isSlotUsed.at(spillSlots.at(neighbour)) = true;
+        }
+        spillSlots.at(i) = std::find(isSlotUsed.begin(), isSlotUsed.end(), false) - isSlotUsed.begin();
+        numSpillSlots = std::max(numSpillSlots, spillSlots.at(i) + 1);
+    }
 
-    for (int i = 0; i < arch.generalPurposeRegisters.size(); i++) {
-        colorToHWRegister.insert({allAssignableColors.at(i), arch.generalPurposeRegisters.at(i)});
-        HWRegisterToColor.insert({arch.generalPurposeRegisters.at(i), allAssignableColors.at(i)});
+    // references that had to be on the stack before may have their address taken, so they keep their own slot
+    uint64_t currentStackOffset = numSpillSlots * 8;
+    for (size_t i = 0; i < references.size(); i++) {
+        auto& ref = references.at(i);
+        if (spillSlots.at(i) != noSlot) {
+            ref->storageLocation = StackSlot{.offset = spillSlots.at(i) * 8};
+        }
+        else if (colors.at(i) == spilledColor) {
+            ref->storageLocation = StackSlot{.offset = currentStackOffset};
+            currentStackOffset += 8;
+        }
+        else if (colors.at(i) == stackPointerColor) {
+            ref->storageLocation = arch.stackPointerRegister;
+        }
+        else {
+            ref->storageLocation = arch.generalPurposeRegisters.at(colors.at(i));
+        }
     }
-    colorToHWRegister.insert({stackPointerColor, arch.stackPointerRegister});
-    HWRegisterToColor.insert({arch.stackPointerRegister, stackPointerColor});
+}
 
-    std::map<std::shared_ptr<RSI::Reference>, std::shared_ptr<Vertex>> referenceToVertex;
-    std::map<std::shared_ptr<Vertex>, std::shared_ptr<RSI::Reference>> vertexToReference;
+/*
+Poletto & Sarkar style linear scan over the instruction order.
+
+Every reference gets one interval from its first to its last live position. Instruction i reads its
+operands at 2i and writes its result at 2i+1, so a value may take over the register of an operand
+that dies in the same instruction. Pinned references reserve their register for their interval.
+When no register is free, the interval ending last is spilled as a whole. Spilled intervals are then
+scanned once more to hand out stack slots, which are reused as soon as their interval expired.
+*/
+void assignRegistersLinearScan(Function& func, Architecture const& arch) {
+    struct Interval {
+        size_t start = std::numeric_limits<size_t>::max();
+        size_t end = 0;
+        size_t reference = 0;
+    };
 
-    const auto addVertexToGraph = [&](auto& operand) {
-        if (std::holds_alternative<std::shared_ptr<RSI::Reference>>(operand)) {
-            std::shared_ptr<Vertex> vert = std::make_shared<Vertex>();
-            auto ref = std::get<std::shared_ptr<RSI::Reference>>(operand);
+    auto const& references = func.meta.referencesByIndex;
+    const auto precolored = getPrecoloring(func, getRegisterColors(arch));
+    const size_t numColors = arch.generalPurposeRegisters.size();
 
-            // keep the color/register
-            if (std::holds_alternative<RSI::HWRegister>(ref->storageLocation)) {
-                vert->color = HWRegisterToColor.at(std::get<RSI::HWRegister>(ref->storageLocation));
-            }
-            if (std::holds_alternative<RSI::StackSlot>(ref->storageLocation)) {
-                vert->color = VertexColor();
-            }
-            if (referenceToVertex.count(ref) == 0) {
-                referenceToVertex.insert_or_assign(ref, vert);
-                vertexToReference.insert_or_assign(vert, ref);
-                interferenceGraph.addVertex(vert);
-            }
-        }
+    std::vector<Interval> intervals(references.size());
+    const auto extend = [&](size_t reference, size_t position) {
+        intervals.at(reference).start = std::min(intervals.at(reference).start, position);
+        intervals.at(reference).end = std::max(intervals.at(reference).end, position);
     };
+    for (size_t i = 0; i < func.instructions.size(); i++) {
+        auto const& instr = func.instructions.at(i);
+        instr.meta.liveVariablesBefore.forEach([&](size_t reference) { extend(reference, 2 * i); });
+        if (std::holds_alternative<std::shared_ptr<Reference>>(instr.result))
+            extend(std::get<std::shared_ptr<Reference>>(instr.result)->index, 2 * i + 1);
+    }
 
-    std::optional<std::reference_wrapper<RSI::Instruction>> lastInstruction;
-    for (auto& instr : func.instructions) {
-        addVertexToGraph(instr.result);
-        addVertexToGraph(instr.op1);
-        addVertexToGraph(instr.op2);
+    // pinned intervals of every register, sorted by start
+    std::vector<std::vector<Interval>> fixedIntervals(numColors);
+    std::vector<Interval> freeIntervals;
+    for (size_t i = 0; i < references.size(); i++) {
+        intervals.at(i).reference = i;
+        if (!precolored.at(i).has_value())
+            freeIntervals.push_back(intervals.at(i));
+        else if (precolored.at(i).value() < numColors)
+            fixedIntervals.at(precolored.at(i).value()).push_back(intervals.at(i));
+    }
+    const auto byStart = [](Interval const& a, Interval const& b) {
+        return a.start < b.start || (a.start == b.start && a.reference < b.reference);
+    };
+    std::sort(freeIntervals.begin(), freeIntervals.end(), byStart);
+    for (auto& fixed : fixedIntervals) {
+        std::sort(fixed.begin(), fixed.end(), byStart);
+    }
 
-        if (lastInstruction.has_value()
-            && std::holds_alternative<std::shared_ptr<RSI::Reference>>(lastInstruction.value().get().result)) {
-            for (auto liveVar : instr.meta.liveVariablesBefore) {
-                if (liveVar == std::get<std::shared_ptr<RSI::Reference>>(lastInstruction.value().get().result))
-                    continue;
+    const auto isReservedDuring = [&](Color color, Interval const& interval) {
+        for (auto const& fixed : fixedIntervals.at(color)) {
+            if (fixed.start > interval.end) break;
+            if (fixed.end >= interval.start) return true;
+        }
+        return false;
+    };
 
-                interferenceGraph.addEdge(
-                    referenceToVertex.at(liveVar),
-                    referenceToVertex.at(
-                        std::get<std::shared_ptr<RSI::Reference>>(lastInstruction.value().get().result)
-                    )
-                );
+    std::vector<Color> colors(references.size(), spilledColor);
+    std::vector<Interval> active;
+    std::vector<bool> isColorFree(numColors, true);
+    std::vector<Interval> spilled;
+
+    for (auto const& current : freeIntervals) {
+        // expire the intervals that ended before this one
+        for (auto it = active.begin(); it != active.end();) {
+            if (it->end < current.start) {
+                isColorFree.at(colors.at(it->reference)) = true;
+                it = active.erase(it);
+            }
+            else {
+                it++;
             }
         }
 
-        for (auto liveVar1 : instr.meta.liveVariablesBefore) {
-            for (auto liveVar2 : instr.meta.liveVariablesBefore) {
-                if (liveVar1 == liveVar2)
-                    continue;
-
-                interferenceGraph.addEdge(referenceToVertex.at(liveVar1), referenceToVertex.at(liveVar2));
+        std::optional<Color> freeColor;
+        for (Color color = 0; color < numColors; color++) {
+            if (isColorFree.at(color) && !isReservedDuring(color, current)) {
+                freeColor = color;
+                break;
             }
         }
+        if (freeColor.has_value()) {
+            colors.at(current.reference) = freeColor.value();
+            isColorFree.at(freeColor.value()) = false;
+            active.push_back(current);
+            continue;
+        }
 
-        lastInstruction = instr;
+        // take the register of the active interval that ends last, if that one lives longer
+        auto victim = active.end();
+        for (auto it = active.begin(); it != active.end(); it++) {
+            if (isReservedDuring(colors.at(it->reference), current)) continue;
+            if (victim == active.end() || it->end > victim->end) victim = it;
+        }
+        if (victim != active.end() && victim->end > current.end) {
+            colors.at(current.reference) = colors.at(victim->reference);
+            colors.at(victim->reference) = spilledColor;
+            spilled.push_back(*victim);
+            active.erase(victim);
+            active.push_back(current);
+        }
+        else {
+            spilled.push_back(current);
+        }
     }
 
-    interferenceGraph.colorIn(allAssignableColors);
-
-    std::map<VertexColor, RSI::StackSlot> colorToStackSlot;
-    uint64_t currentStackOffset = 0;
-
-    for (auto vertex : interferenceGraph) {
-        if (!ContainerTools::contains(allAvailableColors, vertex->color.value())) {
-            if (colorToStackSlot.count(vertex->color.value()))
-                vertexToReference.at(vertex)->storageLocation = colorToStackSlot.at(vertex->color.value());
+    // hand out stack slots, a slot becomes free again once its interval ended
+    std::sort(spilled.begin(), spilled.end(), byStart);
+    std::vector<uint64_t> spillSlots(references.size(), 0);
+    std::vector<std::pair<size_t, uint64_t>> occupiedSlots; // end of the interval, slot
+    std::vector<uint64_t> freeSlots;
+    uint64_t numSpillSlots = 0;
+    for (auto const& interval : spilled) {
+        for (auto it = occupiedSlots.begin(); it != occupiedSlots.end();) {
+            if (it->first < interval.start) {
+                freeSlots.push_back(it->second);
+                it = occupiedSlots.erase(it);
+            }
             else {
-                vertexToReference.at(vertex)->storageLocation = StackSlot{.offset = currentStackOffset};
+                it++;
+            }
+        }
+        uint64_t slot;
+        if (freeSlots.size()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            slot = numSpillSlots++;
+        }
+        spillSlots.at(interval.reference) = slot;
+        occupiedSlots.push_back({interval.end, slot});
+    }
+
+    // references that had to be on the stack before may have their address taken, so they keep their own slot
+    uint64_t currentStackOffset = numSpillSlots * 8;
+    for (size_t i = 0; i < references.size(); i++) {
+        auto& ref = references.at(i);
+        if (precolored.at(i).has_value()) {
+            if (precolored.at(i).value() == spilledColor) {
+                ref->storageLocation = StackSlot{.offset = currentStackOffset};
                 currentStackOffset += 8;
-                colorToStackSlot.insert_or_assign(
-                    vertex->color.value(),
-                    std::get<RSI::StackSlot>(vertexToReference.at(vertex)->storageLocation)
-                );
             }
         }
+        else if (colors.at(i) == spilledColor) {
+            ref->storageLocation = StackSlot{.offset = spillSlots.at(i) * 8};
+        }
         else {
-            vertexToReference.at(vertex)->storageLocation = colorToHWRegister.at(vertex->color.value());
+            ref->storageLocation = arch.generalPurposeRegisters.at(colors.at(i));
         }
     }
 }
@@ -192,14 +512,18 @@ void enumerateRegisters(Function& func, Architecture const& architecture) {
     for (auto ref : func.meta.allReferences) {
         if (std::holds_alternative<RSI::HWRegister>(ref->storageLocation))
             func.meta.allRegisters.insert(std::get<RSI::HWRegister>(ref->storageLocation));
+        // spill slots are shared, so the frame has to reach up to the highest one
         if (std::holds_alternative<RSI::StackSlot>(ref->storageLocation))
-            func.meta.maxStackUsage += 8;
+            func.meta.maxStackUsage = std::max(
+                func.meta.maxStackUsage, std::get<RSI::StackSlot>(ref->storageLocation).offset + 8
+            );
     }
 }
 
 
 bool makeTwoOperandCompatible_prefilter(RSI::Instruction const& instr) {
-    if (instr.type == InstructionType::NEGATE)
+    // unary instructions are translated as "op result", so they need op1 in the result as well
+    if (instr.type == InstructionType::NEGATE || instr.type == InstructionType::BINARY_NOT)
         return true;
 
     if (!std::holds_alternative<std::shared_ptr<Reference>>(instr.result)
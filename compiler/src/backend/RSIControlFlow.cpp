@@ -0,0 +1,70 @@
+#include "R-Sharp/backend/RSIControlFlow.hpp"
+#include "R-Sharp/backend/RSI.hpp"
+#include "R-Sharp/Logging.hpp"
+
+#include <unordered_map>
+
+namespace RSI {
+
+static bool endsBlock(InstructionType type) {
+    return type == InstructionType::JUMP || type == InstructionType::JUMP_IF_ZERO || type == InstructionType::RETURN;
+}
+
+ControlFlowGraph buildControlFlowGraph(Function const& function) {
+    ControlFlowGraph cfg;
+    std::unordered_map<Label const*, size_t> labelToBlock;
+
+    auto const& instructions = function.instructions;
+    for (size_t i = 0; i < instructions.size(); i++) {
+        auto const& instr = instructions.at(i);
+
+        bool startsBlock = i == 0 || instr.type == InstructionType::DEFINE_LABEL
+                        || endsBlock(instructions.at(i - 1).type);
+        if (startsBlock) {
+            if (cfg.blocks.size()) cfg.blocks.back().end = i;
+            cfg.blocks.emplace_back().begin = i;
+        }
+
+        if (instr.type == InstructionType::DEFINE_LABEL) {
+            labelToBlock.insert({std::get<std::shared_ptr<Label>>(instr.op1).get(), cfg.blocks.size() - 1});
+        }
+    }
+    if (cfg.blocks.size()) cfg.blocks.back().end = instructions.size();
+
+    const auto blockOfLabel = [&](Operand const& op) {
+        auto label = std::get<std::shared_ptr<Label>>(op);
+        auto it = labelToBlock.find(label.get());
+        if (it == labelToBlock.end()) {
+            Fatal("Function \"", function.name, "\" jumps to undefined label \"", label->name, "\".");
+        }
+        return it->second;
+    };
+
+    for (size_t b = 0; b < cfg.blocks.size(); b++) {
+        auto& block = cfg.blocks.at(b);
+        auto const& last = instructions.at(block.end - 1);
+        bool hasNextBlock = b + 1 < cfg.blocks.size();
+
+        switch (last.type) {
+            case InstructionType::JUMP: block.successors.push_back(blockOfLabel(last.op1)); break;
+            case InstructionType::JUMP_IF_ZERO:
+                block.successors.push_back(blockOfLabel(last.op2));
+                if (hasNextBlock && block.successors.back() != b + 1) block.successors.push_back(b + 1);
+                break;
+            case InstructionType::RETURN: break;
+            default:
+                if (hasNextBlock) block.successors.push_back(b + 1);
+                break;
+        }
+    }
+
+    for (size_t b = 0; b < cfg.blocks.size(); b++) {
+        for (auto succ : cfg.blocks.at(b).successors) {
+            cfg.blocks.at(succ).predecessors.push_back(b);
+        }
+    }
+
+    return cfg;
+}
+
+}
@@ -7,45 +7,19 @@
 #include "R-Sharp/Utils/ContainerTools.hpp"
 #include "R-Sharp/backend/RSI.hpp"
 #include "R-Sharp/backend/RSI_FWD.hpp"
+#include "R-Sharp/ast/TypeContext.hpp"
 
-#include <map>
+#include <atomic>
 #include <memory>
+#include <utility>
 #include <variant>
 
-RSIGenerator::RSIGenerator(std::shared_ptr<AstProgram> root, std::string R_SharpSource) {
+RSIGenerator::RSIGenerator(std::shared_ptr<AstProgram> root) {
     this->root = root;
-    this->R_SharpSource = R_SharpSource;
 }
 
 int RSIGenerator::sizeFromSemanticalType(std::shared_ptr<AstType> type) {
-    static const std::map<RSharpPrimitiveType, int> primitive_sizes = {
-        {RSharpPrimitiveType::C_void, 1}, // should only be used for pointer arithmetic
-        {RSharpPrimitiveType::I8,     1},
-        {RSharpPrimitiveType::I16,    2},
-        {RSharpPrimitiveType::I32,    4},
-        {RSharpPrimitiveType::I64,    8},
-    };
-
-    switch (type->getType()) {
-        case AstNodeType::AstPrimitiveType: {
-            return primitive_sizes.at(std::static_pointer_cast<AstPrimitiveType>(type)->type);
-        }
-        case AstNodeType::AstPointerType: {
-            return 8;
-        }
-        case AstNodeType::AstArrayType: {
-            auto array = std::static_pointer_cast<AstArrayType>(type);
-            if (!array->size.has_value()) {
-                throw std::runtime_error("Array without size during code generation.");
-            }
-            if (array->size.value()->getType() != AstNodeType::AstInteger) {
-                throw std::runtime_error("Array with non constant size during code generation.");
-            }
-            return sizeFromSemanticalType(array->subtype)
-                 * std::static_pointer_cast<AstInteger>(array->size.value())->value;
-        }
-        default: throw std::runtime_error("Unimplemented type used");
-    }
+    return TypeContext::get().getSize(*type);
 }
 
 RSI::TranslationUnit RSIGenerator::generate() {
@@ -62,8 +36,22 @@ RSI::TranslationUnit RSIGenerator::generate() {
     return generatedTU;
 }
 
+namespace {
+thread_local RSI::Function* uniqueNameFunction = nullptr;
+}
+
+RSIGenerator::UniqueNameScope::UniqueNameScope(RSI::Function& function):
+    previous(std::exchange(uniqueNameFunction, &function)) {}
+RSIGenerator::UniqueNameScope::~UniqueNameScope() {
+    uniqueNameFunction = previous;
+}
+
 std::string RSIGenerator::makeStringUnique(std::string const& prefix) {
-    static uint64_t labelCounter = 0;
+    // the function name can't contain a dot, so these never collide with names made outside a scope
+    if (uniqueNameFunction)
+        return prefix + "_" + uniqueNameFunction->name + "." + std::to_string(uniqueNameFunction->meta.uniqueNames++);
+
+    static std::atomic<uint64_t> labelCounter = 0;
     return prefix + "_" + std::to_string(labelCounter++);
 }
 std::shared_ptr<RSI::Reference> RSIGenerator::getNewReference(std::string const& name) {
@@ -96,7 +84,7 @@ void RSIGenerator::visit(std::shared_ptr<AstProgram> node) {
 
 
     // generate labels
-    for (auto const& child : node->getChildren()) {
+    for (auto const& child : node->items) {
         if (!child)
             continue;
         if (child->getType() == AstNodeType::AstFunctionDefinition) {
@@ -122,7 +110,7 @@ void RSIGenerator::visit(std::shared_ptr<AstProgram> node) {
         }
     }
 
-    for (auto const& child : node->getChildren()) {
+    for (auto const& child : node->items) {
         if (!child)
             continue;
         if (child->getType() == AstNodeType::AstFunctionDefinition) {
@@ -192,10 +180,7 @@ void RSIGenerator::visit(std::shared_ptr<AstBlock> node) {
         setupLocalVariables(node);
 
 
-    for (auto child : node->getChildren()) {
-        if (child)
-            child->accept(this);
-    }
+    visitChildren(node.get());
 
     // don't change stack pointer if it wasn't modified
     if (!node->isMerged)
@@ -424,7 +409,7 @@ void RSIGenerator::visit(std::shared_ptr<AstUnary> node) {
         case AstUnaryType::LogicalNot: instr.type = RSI::InstructionType::LOGICAL_NOT; break;
         default:
             Error("RSI Generator: Unary operator not implemented!");
-            printErrorToken(node->token, R_SharpSource);
+            printErrorToken(node->token);
             exit(1);
             break;
     }
@@ -648,7 +633,7 @@ void RSIGenerator::visit(std::shared_ptr<AstBinary> node) {
         }
         default:
             Error("RSI Generator: Binary operator not implemented!");
-            printErrorToken(node->token, R_SharpSource);
+            printErrorToken(node->token);
             exit(1);
             break;
     }
@@ -1028,7 +1013,7 @@ void RSIGenerator::visit(std::shared_ptr<AstArrayAccess> node) {
     // }
     // else{
     //     Error("NASM Generator: Unimplemented array access!");
-    //     printErrorToken(node->token, R_SharpSource);
+    //     printErrorToken(node->token);
     //     exit(1);
     // }
 }
@@ -1099,7 +1084,7 @@ std::shared_ptr<RSI::GlobalReference> RSIGenerator::defineGlobalData(
     // }
     else {
         Error("RSI Generator: Global variable must be an integer or array. (Found: " + node->toString() + ")");
-        printErrorToken(node->token, R_SharpSource);
+        printErrorToken(node->token);
         exit(1);
     }
 }
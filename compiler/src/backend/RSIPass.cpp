@@ -1,54 +1,137 @@
 #include "R-Sharp/backend/RSIPass.hpp"
 #include "R-Sharp/backend/RSI.hpp"
+#include "R-Sharp/backend/RSIGenerator.hpp"
 #include "R-Sharp/backend/RSITools.hpp"
 #include "R-Sharp/Logging.hpp"
+#include "R-Sharp/Utils/ScopeGuard.hpp"
+#include "R-Sharp/Utils/Statistics.hpp"
+#include "R-Sharp/Utils/Trace.hpp"
 
-void RSIPass::operator()(RSI::Function& function, OutputArchitecture arch) const {
-    auto& fullArch = arch == OutputArchitecture::AArch64 ? aarch64 : x86_64;
+#include <algorithm>
+#include <numeric>
+#include <sstream>
 
-    if (architectures.count(arch) == 0) return;
-    if (isFunctionWide) {
-        perFunctionFunction(function, fullArch);
-        return;
-    }
+bool RSIPass::appliesTo(RSI::InstructionType type) const {
+    if (positiveInstructionTypes.size() && positiveInstructionTypes.count(type) == 0) return false;
+    return negativeInstructionTypes.count(type) == 0;
+}
+
+RSIPassManager::RSIPassManager(std::vector<RSIPass> passes, OutputArchitecture architecture):
+    architecture(architecture) {
+    for (auto& pass : passes) {
+        if (pass.architectures.count(architecture) == 0) continue;
 
-    int i = 0;
-    while (i < function.instructions.size()) {
-        if (positiveInstructionTypes.size() && positiveInstructionTypes.count(function.instructions.at(i).type) == 0) {
-            i++;
-            continue;
+        bool canJoin = sweeps.size() && isFusable(pass) && isFusable(sweeps.back().passes.front());
+        if (canJoin) {
+            for (auto type : pass.positiveInstructionTypes)
+                if (sweeps.back().dispatch[size_t(type)] != noPass) canJoin = false;
         }
-        if (negativeInstructionTypes.count(function.instructions.at(i).type) != 0) {
-            i++;
-            continue;
+        if (!canJoin) {
+            sweeps.push_back({});
+            sweeps.back().dispatch.fill(noPass);
         }
-        if (!prefilter(function.instructions.at(i))) {
-            i++;
-            continue;
+
+        auto& sweep = sweeps.back();
+        if (!pass.isFunctionWide) {
+            for (size_t type = 0; type < RSI::numInstructionTypes; type++)
+                if (pass.appliesTo(RSI::InstructionType(type))) sweep.dispatch[type] = sweep.passes.size();
+        }
+        sweep.passes.push_back(std::move(pass));
+    }
+}
+
+bool RSIPassManager::isFusable(RSIPass const& pass) {
+    return !pass.isFunctionWide && pass.positiveInstructionTypes.size() && pass.negativeInstructionTypes.empty();
+}
+
+void RSIPassManager::run(std::vector<RSI::Function>& functions, ThreadPool& threadPool) {
+    auto const& registerTranslation = architecture == OutputArchitecture::x86_64 ? x86_64.registerTranslation
+                                                                                 : aarch64.registerTranslation;
+
+    auto countInstructions = [&functions]() {
+        return std::accumulate(functions.begin(), functions.end(), size_t(0), [](size_t sum, auto const& func) {
+            return sum + func.instructions.size();
+        });
+    };
+
+    for (auto& sweep : sweeps) {
+        std::string header;
+        for (auto const& pass : sweep.passes) {
+            header += (header.empty() ? "" : " + ") + (pass.humanHeader.empty() ? "<unnamed>" : pass.humanHeader);
         }
 
-        std::vector<RSI::Instruction> before, after;
+        std::vector<std::stringstream> logs(functions.size());
+        {
+            // also printed when a function fails, before its fatal error is reported
+            ScopeGuard printLogs([&]() {
+                for (auto const& log : logs)
+                    Internals::printToStream(*Internals::outputStream, log.str());
+            });
+            auto phase = Statistics::get().phase(header);
+            auto instructionsBefore = Statistics::get().isEnabled() ? countInstructions() : 0;
 
-        perInstructionFunction(function.instructions.at(i), before, after);
-        function.instructions.insert(function.instructions.begin() + i + 1, after.begin(), after.end());
-        function.instructions.insert(function.instructions.begin() + i, before.begin(), before.end());
+            threadPool.parallelFor(functions.size(), [&](size_t i) {
+                auto event = Trace::get().event(functions.at(i).name, header);
+                LogCapture capture(logs.at(i));
+                RSIGenerator::UniqueNameScope names(functions.at(i));
+                apply(sweep, functions.at(i));
+            });
 
-        i += before.size() + after.size();
-        i++;
+            if (Statistics::get().isEnabled()) phase.setInstructionCounts(instructionsBefore, countInstructions());
+        }
+
+        bool isDumped = std::any_of(sweep.passes.begin(), sweep.passes.end(), [](auto const& pass) {
+            return pass.isDumped;
+        });
+        if (!isDumped) continue;
+
+        Print("--------------| ", header, " |--------------");
+        for (auto& func : functions) {
+            Print("; Function \"", func.name, "\"");
+            Print(RSI::stringify_function(func, registerTranslation));
+        }
     }
 }
-void RSIPass::operator()(std::vector<RSI::Function>& functions, OutputArchitecture arch) const {
-    auto const& registerTranslation = arch == OutputArchitecture::x86_64 ? x86_64.registerTranslation
-                                                                         : aarch64.registerTranslation;
 
-    if (architectures.count(arch) == 0) return;
+void RSIPassManager::apply(Sweep const& sweep, RSI::Function& function) const {
+    auto& fullArch = architecture == OutputArchitecture::AArch64 ? aarch64 : x86_64;
+
+    if (sweep.passes.front().isFunctionWide) {
+        sweep.passes.front().perFunctionFunction(function, fullArch);
+        return;
+    }
 
-    bool isSilent = humanHeader.length() == 0;
+    // the result is built in one sweep, inserting into the old vector would shift everything behind it
+    std::vector<RSI::Instruction> instructions;
+    instructions.reserve(function.instructions.size());
 
-    if (!isSilent) Print("--------------| ", humanHeader, " |--------------");
-    for (auto& func : functions) {
-        if (!isSilent) Print("; Function \"", func.name, "\"");
-        (*this)(func, arch);
-        if (!isSilent) Print(RSI::stringify_function(func, registerTranslation));
+    for (auto& instr : function.instructions)
+        applyFrom(sweep, 0, instr, instructions);
+
+    function.instructions = std::move(instructions);
+}
+
+/*
+Runs `instr` through the passes of the sweep starting at `firstPass` and appends
+the result to `instructions`. Instructions inserted by a pass are not revisited by
+that pass, but still go through all passes behind it, just as if every pass had
+its own sweep.
+*/
+void RSIPassManager::applyFrom(
+    Sweep const& sweep, uint8_t firstPass, RSI::Instruction& instr, std::vector<RSI::Instruction>& instructions
+) const {
+    auto passIndex = sweep.dispatch[size_t(instr.type)];
+    if (passIndex == noPass || passIndex < firstPass || !sweep.passes[passIndex].prefilter(instr)) {
+        instructions.push_back(std::move(instr));
+        return;
     }
+
+    std::vector<RSI::Instruction> before, after;
+    sweep.passes[passIndex].perInstructionFunction(instr, before, after);
+
+    for (auto& inserted : before)
+        applyFrom(sweep, passIndex + 1, inserted, instructions);
+    applyFrom(sweep, passIndex + 1, instr, instructions);
+    for (auto& inserted : after)
+        applyFrom(sweep, passIndex + 1, inserted, instructions);
 }
@@ -1,13 +1,18 @@
 #include "R-Sharp/backend/RSIToAssembly.hpp"
 #include "R-Sharp/backend/RSI.hpp"
 #include "R-Sharp/backend/Architecture.hpp"
+#include "R-Sharp/backend/ElfObjectWriter.hpp"
+#include "R-Sharp/backend/X86Encoder.hpp"
 #include "R-Sharp/Logging.hpp"
 
 #include "R-Sharp/Utils/ContainerTools.hpp"
 #include "R-Sharp/Utils/LambdaOverload.hpp"
 #include "R-Sharp/backend/RSI_FWD.hpp"
 
-std::string translateOperand(RSI::Operand const& op, Architecture const& arch, std::string constantPrefix) {
+// `pushedBytes` is how far the stack pointer was moved since the function prologue, stack slots are adjusted by it
+std::string translateOperand(
+    RSI::Operand const& op, Architecture const& arch, std::string constantPrefix, uint64_t pushedBytes = 0
+) {
     return std::visit(
         lambda_overload{
             [&](RSI::Constant const& x) { return constantPrefix + std::to_string(x.value); },
@@ -24,7 +29,7 @@ std::string translateOperand(RSI::Operand const& op, Architecture const& arch, s
                         [](std::monostate) -> std::string { return "(none)"; },
                         [&](RSI::StackSlot slot) -> std::string {
                             return "[" + arch.registerTranslation.at(arch.stackPointerRegister) + "+"
-                                 + std::to_string(slot.offset) + "]";
+                                 + std::to_string(slot.offset + pushedBytes) + "]";
                         },
                     },
                     x->storageLocation
@@ -240,22 +245,21 @@ std::string rsiToAarch64(RSI::Function const& function) {
                 if (!std::holds_alternative<RSI::Constant>(instr.op2))
                     Fatal("call instruction has non constant number of arguments.");
 
-                auto regsToPreserve = next_instr.has_value() ? next_instr.value().get().meta.liveVariablesBefore
-                                                             : std::set<std::shared_ptr<RSI::Reference>>();
-                regsToPreserve.erase(std::get<std::shared_ptr<RSI::Reference>>(instr.result));
+                std::vector<std::shared_ptr<RSI::Reference>> regsToPreserve;
+                if (next_instr.has_value()) {
+                    next_instr.value().get().meta.liveVariablesBefore.forEach([&](size_t index) {
+                        auto ref = function.meta.referencesByIndex.at(index);
+                        if (ref == std::get<std::shared_ptr<RSI::Reference>>(instr.result)) return;
+                        // values on the stack survive the call
+                        if (!std::holds_alternative<RSI::HWRegister>(ref->storageLocation)) return;
 
-                // don't save callee saved registers
-                for (auto reg_it = regsToPreserve.begin(); reg_it != regsToPreserve.end();) {
-                    if (std::holds_alternative<RSI::HWRegister>((*reg_it)->storageLocation)) {
-                        auto hwreg = std::get<RSI::HWRegister>((*reg_it)->storageLocation);
+                        // don't save callee saved registers
+                        auto hwreg = std::get<RSI::HWRegister>(ref->storageLocation);
                         if (ContainerTools::contains(aarch64.calleeSavedRegisters, hwreg)
-                            || hwreg == aarch64.returnValueRegister) {
-                            reg_it = regsToPreserve.erase(reg_it);
-                            continue;
-                        }
-                    }
-
-                    reg_it++;
+                            || hwreg == aarch64.returnValueRegister)
+                            return;
+                        regsToPreserve.push_back(ref);
+                    });
                 }
 
                 // save registers
@@ -328,10 +332,121 @@ bool isRegister(RSI::Operand const& op, NasmRegisters reg) {
         && std::get<RSI::HWRegister>(loc) == x86_64.allRegisters.at(static_cast<int>(reg));
 }
 
-std::string rsiToNasm(RSI::Function const& function) {
-    std::string result = "";
+NasmRegisters toNasmRegister(RSI::HWRegister reg) {
+    for (size_t i = 0; i < x86_64.allRegisters.size(); i++) {
+        if (x86_64.allRegisters[i] == reg) return static_cast<NasmRegisters>(i);
+    }
+    Fatal("Register is not an x86-64 register.");
+}
+
+// `pushedBytes` is how far the stack pointer was moved since the function prologue, stack slots are adjusted by it
+X86::Operand translateOperandX86(RSI::Operand const& op, uint64_t pushedBytes) {
+    return std::visit(
+        lambda_overload{
+            [&](RSI::Constant const& x) -> X86::Operand { return X86::Immediate{int64_t(x.value)}; },
+            [&](RSI::DynamicConstant const& x) -> X86::Operand {
+                if (x.value == nullptr) {
+                    Fatal("Dynamic constrant wasn't resolved.");
+                }
+                return X86::Immediate{int64_t(*x.value)};
+            },
+            [&](std::shared_ptr<RSI::Reference> x) {
+                return std::visit(
+                    lambda_overload{
+                        [&](RSI::HWRegister reg) -> X86::Operand { return X86::Register{toNasmRegister(reg)}; },
+                        [](std::monostate) -> X86::Operand { return X86::Invalid{"(none)"}; },
+                        [&](RSI::StackSlot slot) -> X86::Operand {
+                            return X86::Memory{
+                                .base = NasmRegisters::RSP,
+                                .displacement = int64_t(slot.offset + pushedBytes),
+                            };
+                        },
+                    },
+                    x->storageLocation
+                );
+            },
+            [](std::shared_ptr<RSI::GlobalReference> x) -> X86::Operand { return X86::Symbol{x->name}; },
+            [](std::shared_ptr<RSI::Label> x) -> X86::Operand { return X86::Symbol{x->name}; },
+            [](std::monostate const&) -> X86::Operand {
+                Fatal("Empty RSI operand used!");
+                return X86::Invalid{};
+            },
+        },
+        op
+    );
+}
+
+// the memory the operand points to, NASM's "[operand]"
+X86::Operand toAddress(X86::Operand const& op) {
+    return std::visit(
+        lambda_overload{
+            [](X86::Register const& x) -> X86::Operand { return X86::Memory{.base = x.reg}; },
+            [](X86::Immediate const& x) -> X86::Operand { return X86::Memory{.displacement = x.value}; },
+            [](X86::Symbol const& x) -> X86::Operand { return X86::Memory{.symbol = x.name}; },
+            [&](auto const&) -> X86::Operand { return X86::Invalid{"[" + X86::toNasm(op) + "]"}; },
+        },
+        op
+    );
+}
 
-    const auto translateOperandNasm = [&](RSI::Operand const& op) { return translateOperand(op, x86_64, ""); };
+std::vector<X86::Instruction> rsiToX86(RSI::Function const& function) {
+    using X86::makeInstruction;
+    using X86::Mnemonic;
+    using X86::Register;
+
+    std::vector<X86::Instruction> result;
+    result.reserve(function.instructions.size() * 2);
+
+    uint64_t pushedBytes = 0;
+    const auto translateOperandNasm = [&](RSI::Operand const& op) {
+        return translateOperandX86(op, pushedBytes);
+    };
+    // memory operands need an explicit size when the instruction doesn't imply one
+    const auto translateSizedOperandNasm = [&](RSI::Operand const& op) {
+        auto translated = translateOperandNasm(op);
+        if (auto memory = std::get_if<X86::Memory>(&translated)) memory->sizeKeyword = 8;
+        return translated;
+    };
+    const auto emit = [&](X86::Instruction instruction) {
+        result.push_back(std::move(instruction));
+    };
+    const auto emitRegister = [&](Mnemonic mnemonic, NasmRegisters reg) {
+        emit(makeInstruction(mnemonic, Register{reg}));
+    };
+    // x86 instructions take at most one memory operand, otherwise the source is passed through rax
+    const auto translateTwoOperandNasm = [&](Mnemonic mnemonic, RSI::Operand const& destination,
+                                             RSI::Operand const& source, bool hasQwordKeyword = false) {
+        if (!X86::isMemory(translateOperandNasm(destination)) || !X86::isMemory(translateOperandNasm(source))) {
+            emit(makeInstruction(
+                mnemonic, translateOperandNasm(destination), translateOperandNasm(source), hasQwordKeyword
+            ));
+            return;
+        }
+
+        emitRegister(Mnemonic::PUSH, NasmRegisters::RAX);
+        pushedBytes += 8;
+        emit(makeInstruction(Mnemonic::MOV, Register{NasmRegisters::RAX}, translateOperandNasm(source)));
+        emit(makeInstruction(
+            mnemonic, translateOperandNasm(destination), Register{NasmRegisters::RAX}, hasQwordKeyword
+        ));
+        pushedBytes -= 8;
+        emitRegister(Mnemonic::POP, NasmRegisters::RAX);
+    };
+    // setcc only writes the lowest byte, so the rest is cleared before (memory) or after (register)
+    const auto translateSetConditionNasm = [&](Mnemonic setCondition, RSI::Operand const& destination) {
+        auto translated = translateOperandNasm(destination);
+        if (auto memory = std::get_if<X86::Memory>(&translated)) {
+            emit(makeInstruction(Mnemonic::MOV, *memory, X86::Immediate{0}, true));
+            memory->sizeKeyword = 1;
+            emit(makeInstruction(setCondition, *memory));
+            return;
+        }
+        auto reg = std::get_if<Register>(&translated);
+        if (!reg) Fatal("The result of a comparison is neither in a register nor on the stack.");
+
+        emit(makeInstruction(setCondition, Register{reg->reg, 1}));
+        emit(makeInstruction(Mnemonic::MOVZX, Register{reg->reg, 4}, Register{reg->reg, 1}));
+    };
 
     for (auto instr_it = function.instructions.begin(); instr_it != function.instructions.end(); instr_it++) {
         RSI::Instruction const& instr = *instr_it;
@@ -353,39 +468,39 @@ std::string rsiToNasm(RSI::Function const& function) {
         switch (instr.type) {
             case RSI::InstructionType::ADD:
                 ENSURE_RESULT(instr);
-                result += "add " + translateOperandNasm(instr.result) + ", " + translateOperandNasm(instr.op2)
-                        + "\n";
+                translateTwoOperandNasm(Mnemonic::ADD, instr.result, instr.op2);
                 break;
             case RSI::InstructionType::SUBTRACT:
                 ENSURE_RESULT(instr);
-                result += "sub " + translateOperandNasm(instr.result) + ", " + translateOperandNasm(instr.op2)
-                        + "\n";
+                translateTwoOperandNasm(Mnemonic::SUB, instr.result, instr.op2);
                 break;
             case RSI::InstructionType::MULTIPLY:
                 ENSURE_RESULT(instr);
-                result += "push rax\n";
-                result += "push rdx\n";
+                emitRegister(Mnemonic::PUSH, NasmRegisters::RAX);
+                emitRegister(Mnemonic::PUSH, NasmRegisters::RDX);
+                pushedBytes = 16;
                 if (isRegister(instr.op2, NasmRegisters::RAX)) {
-                    result += "imul " + translateOperandNasm(instr.op1) + "\n";
+                    emit(makeInstruction(Mnemonic::IMUL, translateSizedOperandNasm(instr.op1)));
                 }
                 else {
-                    result += "mov rax, " + translateOperandNasm(instr.op1) + "\n";
-                    result += "imul " + translateOperandNasm(instr.op2) + "\n";
+                    emit(makeInstruction(Mnemonic::MOV, Register{NasmRegisters::RAX}, translateOperandNasm(instr.op1)));
+                    emit(makeInstruction(Mnemonic::IMUL, translateSizedOperandNasm(instr.op2)));
                 }
 
-                result += "mov " + translateOperandNasm(instr.result) + ", rax\n";
+                emit(makeInstruction(Mnemonic::MOV, translateOperandNasm(instr.result), Register{NasmRegisters::RAX}));
+                pushedBytes = 0;
 
                 if (!isRegister(instr.result, NasmRegisters::RDX)) {
-                    result += "pop rdx\n";
+                    emitRegister(Mnemonic::POP, NasmRegisters::RDX);
                 }
                 else
-                    result += "add rsp, 8\n";
+                    emit(makeInstruction(Mnemonic::ADD, Register{NasmRegisters::RSP}, X86::Immediate{8}));
 
                 if (!isRegister(instr.result, NasmRegisters::RAX)) {
-                    result += "pop rax\n";
+                    emitRegister(Mnemonic::POP, NasmRegisters::RAX);
                 }
                 else
-                    result += "add rsp, 8\n";
+                    emit(makeInstruction(Mnemonic::ADD, Register{NasmRegisters::RSP}, X86::Immediate{8}));
 
                 break;
             case RSI::InstructionType::DIVIDE:
@@ -404,183 +519,184 @@ std::string rsiToNasm(RSI::Function const& function) {
                     );
                 }
 
-                result += "push rdx\n";
-                result += "cqo\n";
-                result += "idiv " + translateOperandNasm(instr.op2) + "\n";
-                result += "pop rdx\n";
+                emitRegister(Mnemonic::PUSH, NasmRegisters::RDX);
+                emit(makeInstruction(Mnemonic::CQO));
+                // cqo overwrites rdx, so a divisor in rdx is read from the copy that was just pushed
+                pushedBytes = 8;
+                if (isRegister(instr.op2, NasmRegisters::RDX))
+                    emit(makeInstruction(Mnemonic::IDIV, X86::Memory{.base = NasmRegisters::RSP, .sizeKeyword = 8}));
+                else
+                    emit(makeInstruction(Mnemonic::IDIV, translateSizedOperandNasm(instr.op2)));
+                pushedBytes = 0;
+                emitRegister(Mnemonic::POP, NasmRegisters::RDX);
 
                 break;
             case RSI::InstructionType::MODULO:
                 ENSURE_RESULT(instr);
 
-                if (!isRegister(instr.result, NasmRegisters::RAX))
-                    result += "push rax\n";
-                if (!isRegister(instr.result, NasmRegisters::RDX))
-                    result += "push rdx\n";
+                if (!isRegister(instr.result, NasmRegisters::RAX)) {
+                    emitRegister(Mnemonic::PUSH, NasmRegisters::RAX);
+                    pushedBytes += 8;
+                }
+                if (!isRegister(instr.result, NasmRegisters::RDX)) {
+                    emitRegister(Mnemonic::PUSH, NasmRegisters::RDX);
+                    pushedBytes += 8;
+                }
 
-                result += "mov rax, " + translateOperandNasm(instr.op1) + "\n";
-                result += "cqo\n";
-                result += "idiv " + translateOperandNasm(instr.op2) + "\n";
-                result += "mov " + translateOperandNasm(instr.result) + ", rdx\n";
+                {
+                    // rax and rdx get overwritten before the division, so a divisor in them is copied to the stack
+                    bool divisorIsOverwritten = std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.op2)
+                                             && (isRegister(instr.op2, NasmRegisters::RAX)
+                                                 || isRegister(instr.op2, NasmRegisters::RDX));
+                    if (divisorIsOverwritten) {
+                        emit(makeInstruction(Mnemonic::PUSH, translateOperandNasm(instr.op2)));
+                        pushedBytes += 8;
+                    }
+
+                    emit(makeInstruction(Mnemonic::MOV, Register{NasmRegisters::RAX}, translateOperandNasm(instr.op1)));
+                    emit(makeInstruction(Mnemonic::CQO));
+                    if (divisorIsOverwritten) {
+                        emit(makeInstruction(Mnemonic::IDIV, X86::Memory{.base = NasmRegisters::RSP, .sizeKeyword = 8}));
+                        emit(makeInstruction(Mnemonic::ADD, Register{NasmRegisters::RSP}, X86::Immediate{8}));
+                        pushedBytes -= 8;
+                    }
+                    else
+                        emit(makeInstruction(Mnemonic::IDIV, translateSizedOperandNasm(instr.op2)));
+                }
+                emit(makeInstruction(Mnemonic::MOV, translateOperandNasm(instr.result), Register{NasmRegisters::RDX}));
+                pushedBytes = 0;
 
                 if (!isRegister(instr.result, NasmRegisters::RDX))
-                    result += "pop rdx\n";
+                    emitRegister(Mnemonic::POP, NasmRegisters::RDX);
 
                 if (!isRegister(instr.result, NasmRegisters::RAX))
-                    result += "pop rax\n";
+                    emitRegister(Mnemonic::POP, NasmRegisters::RAX);
 
                 break;
             case RSI::InstructionType::NEGATE:
                 ENSURE_RESULT(instr);
-                result += "neg " + translateOperandNasm(instr.result) + "\n";
+                emit(makeInstruction(Mnemonic::NEG, translateOperandNasm(instr.result)));
                 break;
             case RSI::InstructionType::BINARY_NOT:
                 ENSURE_RESULT(instr);
-                result += "not " + translateOperandNasm(instr.result) + "\n";
+                emit(makeInstruction(Mnemonic::NOT, translateOperandNasm(instr.result)));
                 break;
 
             case RSI::InstructionType::EQUAL:
                 ENSURE_RESULT(instr);
-                result += "cmp " + translateOperandNasm(instr.op1) + ", " + translateOperandNasm(instr.op2)
-                        + "\n";
-                result += "sete " + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 1))
-                        + "\n";
-                result += "movzx "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 4)) + ", "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 1)) + "\n";
+                translateTwoOperandNasm(Mnemonic::CMP, instr.op1, instr.op2);
+                translateSetConditionNasm(Mnemonic::SETE, instr.result);
                 break;
             case RSI::InstructionType::NOT_EQUAL:
                 ENSURE_RESULT(instr);
-                result += "cmp " + translateOperandNasm(instr.op1) + ", " + translateOperandNasm(instr.op2)
-                        + "\n";
-                result += "setne "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 1)) + "\n";
-                result += "movzx "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 4)) + ", "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 1)) + "\n";
+                translateTwoOperandNasm(Mnemonic::CMP, instr.op1, instr.op2);
+                translateSetConditionNasm(Mnemonic::SETNE, instr.result);
                 break;
             case RSI::InstructionType::LESS_THAN:
                 ENSURE_RESULT(instr);
-                result += "cmp " + translateOperandNasm(instr.op1) + ", " + translateOperandNasm(instr.op2)
-                        + "\n";
-                result += "setl " + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 1))
-                        + "\n";
-                result += "movzx "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 4)) + ", "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 1)) + "\n";
+                translateTwoOperandNasm(Mnemonic::CMP, instr.op1, instr.op2);
+                translateSetConditionNasm(Mnemonic::SETL, instr.result);
                 break;
             case RSI::InstructionType::LESS_THAN_OR_EQUAL:
                 ENSURE_RESULT(instr);
-                result += "cmp " + translateOperandNasm(instr.op1) + ", " + translateOperandNasm(instr.op2)
-                        + "\n";
-                result += "setle "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 1)) + "\n";
-                result += "movzx "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 4)) + ", "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 1)) + "\n";
+                translateTwoOperandNasm(Mnemonic::CMP, instr.op1, instr.op2);
+                translateSetConditionNasm(Mnemonic::SETLE, instr.result);
                 break;
             case RSI::InstructionType::GREATER_THAN:
                 ENSURE_RESULT(instr);
-                result += "cmp " + translateOperandNasm(instr.op1) + ", " + translateOperandNasm(instr.op2)
-                        + "\n";
-                result += "setg " + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 1))
-                        + "\n";
-                result += "movzx "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 4)) + ", "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 1)) + "\n";
+                translateTwoOperandNasm(Mnemonic::CMP, instr.op1, instr.op2);
+                translateSetConditionNasm(Mnemonic::SETG, instr.result);
                 break;
             case RSI::InstructionType::GREATER_THAN_OR_EQUAL:
                 ENSURE_RESULT(instr);
-                result += "cmp " + translateOperandNasm(instr.op1) + ", " + translateOperandNasm(instr.op2)
-                        + "\n";
-                result += "setge "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 1)) + "\n";
-                result += "movzx "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 4)) + ", "
-                        + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 1)) + "\n";
+                translateTwoOperandNasm(Mnemonic::CMP, instr.op1, instr.op2);
+                translateSetConditionNasm(Mnemonic::SETGE, instr.result);
                 break;
             case RSI::InstructionType::STORE_GLOBAL:
-                result += "mov QWORD [" + translateOperandNasm(instr.op1) + "], "
-                        + translateOperandNasm(instr.op2) + "\n";
+                emit(makeInstruction(
+                    Mnemonic::MOV, toAddress(translateOperandNasm(instr.op1)), translateOperandNasm(instr.op2), true
+                ));
                 break;
-            break;
             case RSI::InstructionType::LOAD_GLOBAL:
                 if (std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.result)
                     && std::holds_alternative<std::shared_ptr<RSI::GlobalReference>>(instr.op1)) {
-                    result += "mov QWORD " + translateOperandNasm(instr.result) + ", ["
-                            + translateOperandNasm(instr.op1) + "]\n";
+                    emit(makeInstruction(
+                        Mnemonic::MOV, translateOperandNasm(instr.result), toAddress(translateOperandNasm(instr.op1)), true
+                    ));
                 }
                 else {
                     Fatal("LOAD_GLOBAL can only move from global to reference.");
                 }
                 break;
             case RSI::InstructionType::MOVE:
-                result += "mov QWORD ";
-                if (std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.result))
-                    result += translateOperandNasm(instr.result);
-                else
+                // references sharing a register or spill slot
+                if (std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.result)
+                    && std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.op1)
+                    && X86::toNasm(translateOperandNasm(instr.result)) == X86::toNasm(translateOperandNasm(instr.op1)))
+                    break;
+
+                if (!std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.result))
                     Fatal("Unknown type of result used for move instruction");
-                result += ", ";
-                if (std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.op1))
-                    result += translateOperandNasm(instr.op1);
-                else if (std::holds_alternative<RSI::Constant>(instr.op1))
-                    result += translateOperandNasm(instr.op1);
-                else if (std::holds_alternative<RSI::DynamicConstant>(instr.op1))
-                    result += translateOperandNasm(instr.op1);
-                else
+                if (!std::holds_alternative<std::shared_ptr<RSI::Reference>>(instr.op1)
+                    && !std::holds_alternative<RSI::Constant>(instr.op1)
+                    && !std::holds_alternative<RSI::DynamicConstant>(instr.op1))
                     Fatal("Unknown type of operand used for move instruction");
-                result += "\n";
+
+                translateTwoOperandNasm(Mnemonic::MOV, instr.result, instr.op1, true);
                 break;
             case RSI::InstructionType::STORE_MEMORY:
                 if (std::holds_alternative<std::shared_ptr<RSI::GlobalReference>>(instr.op1) || std::holds_alternative<std::shared_ptr<RSI::GlobalReference>>(instr.op1)){
                     Fatal("STORE_MEMORY used for accessing global. Use STORE_GLOBAL.");
                 }
 
-                result += "mov QWORD [" + translateOperandNasm(instr.op1) + "], "
-                        + translateOperandNasm(instr.op2) + "\n";
+                emit(makeInstruction(
+                    Mnemonic::MOV, toAddress(translateOperandNasm(instr.op1)), translateOperandNasm(instr.op2), true
+                ));
                 break;
             case RSI::InstructionType::LOAD_MEMORY:
                 if (std::holds_alternative<std::shared_ptr<RSI::GlobalReference>>(instr.op1) || std::holds_alternative<std::shared_ptr<RSI::GlobalReference>>(instr.result)){
                     Fatal("LOAD_MEMORY used for accessing global. Use LOAD_GLOBAL.");
                 }
-                result += "mov QWORD " + translateOperandNasm(instr.result) + ", ["
-                        + translateOperandNasm(instr.op1) + "]\n";
+                emit(makeInstruction(
+                    Mnemonic::MOV, translateOperandNasm(instr.result), toAddress(translateOperandNasm(instr.op1)), true
+                ));
                 break;
             case RSI::InstructionType::RETURN:
-                result += "mov rax, " + translateOperandNasm(instr.op1) + "\n";
+                emit(makeInstruction(Mnemonic::MOV, Register{NasmRegisters::RAX}, translateOperandNasm(instr.op1)));
 
-                result += "add rsp, " + std::to_string(function.meta.maxStackUsage) + "\n";
+                emit(makeInstruction(
+                    Mnemonic::ADD, Register{NasmRegisters::RSP}, X86::Immediate{int64_t(function.meta.maxStackUsage)}
+                ));
 
                 // restore callee saved regs
                 for (auto reg_it = function.meta.allRegisters.rbegin(); reg_it != function.meta.allRegisters.rend();
                      reg_it++) {
                     if (ContainerTools::contains(x86_64.calleeSavedRegisters, *reg_it)) {
-                        result += "pop " + x86_64.registerTranslation.at(*reg_it) + "\n";
+                        emitRegister(Mnemonic::POP, toNasmRegister(*reg_it));
                     }
                 }
 
-                result += "ret\n";
+                emit(makeInstruction(Mnemonic::RET));
                 break;
             case RSI::InstructionType::LOGICAL_NOT:
-                result += "cmp " + translateOperandNasm(instr.op1) + ", 0\n";
-                result += "mov " + translateOperandNasm(instr.result) + ", 0\n";
-                result += "sete " + nasmRegisterSize.at(std::make_pair(translateOperandNasm(instr.result), 1))
-                        + "\n";
+                emit(makeInstruction(Mnemonic::CMP, translateSizedOperandNasm(instr.op1), X86::Immediate{0}));
+                translateSetConditionNasm(Mnemonic::SETE, instr.result);
                 break;
 
             case RSI::InstructionType::NOP: break;
             case RSI::InstructionType::DEFINE_LABEL:
-                result += std::get<std::shared_ptr<RSI::Label>>(instr.op1)->name + ":\n";
+                emit(makeInstruction(Mnemonic::LABEL, translateOperandNasm(instr.op1)));
                 break;
             case RSI::InstructionType::JUMP:
-                result += "jmp " + std::get<std::shared_ptr<RSI::Label>>(instr.op1)->name + "\n";
+                emit(makeInstruction(Mnemonic::JMP, translateOperandNasm(instr.op1)));
                 break;
             case RSI::InstructionType::JUMP_IF_ZERO:
-                result += "cmp " + translateOperandNasm(instr.op1) + ", 0\n";
-                result += "je " + std::get<std::shared_ptr<RSI::Label>>(instr.op2)->name + "\n";
+                emit(makeInstruction(Mnemonic::CMP, translateOperandNasm(instr.op1), X86::Immediate{0}));
+                emit(makeInstruction(Mnemonic::JE, translateOperandNasm(instr.op2)));
                 break;
             case RSI::InstructionType::STORE_PARAMETER:
-                result += "push " + translateOperandNasm(instr.op1) + "\n";
+                emit(makeInstruction(Mnemonic::PUSH, translateSizedOperandNasm(instr.op1)));
+                pushedBytes += 8;
                 break;
             case RSI::InstructionType::LOAD_PARAMETER: {
                 break;
@@ -589,29 +705,27 @@ std::string rsiToNasm(RSI::Function const& function) {
                 if (!std::holds_alternative<RSI::Constant>(instr.op2))
                     Fatal("call instruction has non constant number of arguments.");
 
-                auto regsToPreserve = next_instr.has_value() ? next_instr.value().get().meta.liveVariablesBefore
-                                                             : std::set<std::shared_ptr<RSI::Reference>>();
-                regsToPreserve.erase(std::get<std::shared_ptr<RSI::Reference>>(instr.result));
-
-                // don't save callee saved registers
-                for (auto reg_it = regsToPreserve.begin(); reg_it != regsToPreserve.end();) {
-                    if (std::holds_alternative<RSI::HWRegister>((*reg_it)->storageLocation)
-                        && ContainerTools::contains(
-                            x86_64.calleeSavedRegisters,
-                            std::get<RSI::HWRegister>((*reg_it)->storageLocation)
-                        )) {
-                        reg_it = regsToPreserve.erase(reg_it);
-                    }
-                    else {
-                        reg_it++;
-                    }
+                std::vector<std::shared_ptr<RSI::Reference>> regsToPreserve;
+                if (next_instr.has_value()) {
+                    next_instr.value().get().meta.liveVariablesBefore.forEach([&](size_t index) {
+                        auto ref = function.meta.referencesByIndex.at(index);
+                        if (ref == std::get<std::shared_ptr<RSI::Reference>>(instr.result)) return;
+                        // values on the stack survive the call
+                        if (!std::holds_alternative<RSI::HWRegister>(ref->storageLocation)) return;
+
+                        // don't save callee saved registers
+                        if (ContainerTools::contains(
+                                x86_64.calleeSavedRegisters, std::get<RSI::HWRegister>(ref->storageLocation)
+                            ))
+                            return;
+                        regsToPreserve.push_back(ref);
+                    });
                 }
 
                 // save registers
                 for (auto reg : regsToPreserve) {
                     if (std::holds_alternative<RSI::HWRegister>(reg->storageLocation)) {
-                        result += "push " + x86_64.registerTranslation.at(std::get<RSI::HWRegister>(reg->storageLocation))
-                                + "\n";
+                        emitRegister(Mnemonic::PUSH, toNasmRegister(std::get<RSI::HWRegister>(reg->storageLocation)));
                     }
                 }
 
@@ -627,26 +741,30 @@ std::string rsiToNasm(RSI::Function const& function) {
 
                     int stackOffset = regsToPreserve.size() * pushSize;
                     for (auto it = usedParameterRegs.rbegin(); it != usedParameterRegs.rend(); it++) {
-                        std::string currentParameterRegister = x86_64.registerTranslation.at(*it);
-                        result += "mov " + currentParameterRegister + ", [rsp+" + std::to_string(stackOffset)
-                                + "]\n";
+                        emit(makeInstruction(
+                            Mnemonic::MOV,
+                            Register{toNasmRegister(*it)},
+                            X86::Memory{.base = NasmRegisters::RSP, .displacement = stackOffset}
+                        ));
                         stackOffset += pushSize;
                     }
                 }
-                result += "call " + std::get<std::shared_ptr<RSI::Label>>(instr.op1)->name + "\n";
+                emit(makeInstruction(Mnemonic::CALL, translateOperandNasm(instr.op1)));
 
 
                 // restore registers
                 for (auto reg_it = regsToPreserve.rbegin(); reg_it != regsToPreserve.rend(); reg_it++) {
                     auto reg = *reg_it;
                     if (std::holds_alternative<RSI::HWRegister>(reg->storageLocation)) {
-                        result += "pop " + x86_64.registerTranslation.at(std::get<RSI::HWRegister>(reg->storageLocation))
-                                + "\n";
+                        emitRegister(Mnemonic::POP, toNasmRegister(std::get<RSI::HWRegister>(reg->storageLocation)));
                     }
                 }
 
                 // reclaim parameters
-                result += "add rsp, " + std::to_string(usedParameterRegs.size() * pushSize) + "\n";
+                emit(makeInstruction(
+                    Mnemonic::ADD, Register{NasmRegisters::RSP}, X86::Immediate{int64_t(usedParameterRegs.size() * pushSize)}
+                ));
+                pushedBytes = 0;
 
                 break;
             }
@@ -654,10 +772,12 @@ std::string rsiToNasm(RSI::Function const& function) {
                 // save callee saved regs
                 for (auto reg : function.meta.allRegisters) {
                     if (ContainerTools::contains(x86_64.calleeSavedRegisters, reg)) {
-                        result += "push " + x86_64.registerTranslation.at(reg) + "\n";
+                        emitRegister(Mnemonic::PUSH, toNasmRegister(reg));
                     }
                 }
-                result += "sub rsp, " + std::to_string(function.meta.maxStackUsage) + "\n";
+                emit(makeInstruction(
+                    Mnemonic::SUB, Register{NasmRegisters::RSP}, X86::Immediate{int64_t(function.meta.maxStackUsage)}
+                ));
                 break;
             case RSI::InstructionType::SET_LIVE: break;
 
@@ -669,3 +789,31 @@ std::string rsiToNasm(RSI::Function const& function) {
 
     return result;
 }
+
+std::string rsiToNasm(RSI::Function const& function) {
+    std::string result;
+    for (auto const& instruction : rsiToX86(function))
+        result += X86::toNasm(instruction) + "\n";
+    return result;
+}
+
+std::optional<std::string> rsiToElfObject(RSI::TranslationUnit const& translationUnit) {
+    X86Encoder encoder;
+    for (auto const& function : translationUnit.functions) {
+        for (auto const& instruction : rsiToX86(function)) {
+            if (!encoder.encode(instruction)) return std::nullopt;
+        }
+    }
+    encoder.finish();
+
+    ElfObjectWriter writer(encoder);
+    for (auto const& label : translationUnit.externLabels)
+        writer.addExtern(label->name);
+    for (auto const& function : translationUnit.functions)
+        writer.addGlobal(function.name);
+    for (auto const& [reference, value] : translationUnit.initializedGlobalVariables)
+        writer.addVariable(reference->name, value.value);
+    for (auto const& reference : translationUnit.uninitializedGlobalVariables)
+        writer.addUninitializedVariable(reference->name, 8);
+    return writer.write();
+}
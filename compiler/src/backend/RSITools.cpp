@@ -40,17 +40,17 @@ std::string stringify_operand(Operand const& op, std::map<HWRegister, std::strin
 std::string stringify_function(RSI::Function const& function, std::map<HWRegister, std::string> const& registerTranslation) {
     const uint maxLiveVariableStringSize = 55;
     std::string result = "";
-    for (auto instr : function.instructions) {
+    for (auto const& instr : function.instructions) {
         std::string prefix;
         prefix += "[";
         bool isFirst = true;
-        for (auto liveVar : instr.meta.liveVariablesBefore) {
+        instr.meta.liveVariablesBefore.forEach([&](size_t index) {
             if (!isFirst) {
                 prefix += ", ";
             }
             isFirst = false;
-            prefix += stringify_operand(liveVar, registerTranslation);
-        }
+            prefix += stringify_operand(function.meta.referencesByIndex.at(index), registerTranslation);
+        });
         prefix += "]  ";
         while (prefix.length() < maxLiveVariableStringSize)
             prefix += " ";
@@ -0,0 +1,96 @@
+#include "R-Sharp/backend/X86Assembly.hpp"
+#include "R-Sharp/Utils/LambdaOverload.hpp"
+
+namespace X86 {
+
+namespace {
+std::string_view mnemonicName(Mnemonic mnemonic) {
+    switch (mnemonic) {
+        case Mnemonic::ADD:   return "add";
+        case Mnemonic::SUB:   return "sub";
+        case Mnemonic::IMUL:  return "imul";
+        case Mnemonic::IDIV:  return "idiv";
+        case Mnemonic::CQO:   return "cqo";
+        case Mnemonic::NEG:   return "neg";
+        case Mnemonic::NOT:   return "not";
+        case Mnemonic::CMP:   return "cmp";
+        case Mnemonic::MOV:   return "mov";
+        case Mnemonic::MOVZX: return "movzx";
+        case Mnemonic::SETE:  return "sete";
+        case Mnemonic::SETNE: return "setne";
+        case Mnemonic::SETL:  return "setl";
+        case Mnemonic::SETLE: return "setle";
+        case Mnemonic::SETG:  return "setg";
+        case Mnemonic::SETGE: return "setge";
+        case Mnemonic::JMP:   return "jmp";
+        case Mnemonic::JE:    return "je";
+        case Mnemonic::CALL:  return "call";
+        case Mnemonic::RET:   return "ret";
+        case Mnemonic::PUSH:  return "push";
+        case Mnemonic::POP:   return "pop";
+        case Mnemonic::LABEL: return "";
+    }
+    return "";
+}
+
+std::string registerName(NasmRegisters reg, uint8_t size) {
+    auto const& name = x86_64.registerTranslation.at(x86_64.allRegisters.at(static_cast<int>(reg)));
+    return size == 8 ? name : nasmRegisterSize.at(std::make_pair(name, int(size)));
+}
+} // namespace
+
+Instruction makeInstruction(Mnemonic mnemonic, bool hasQwordKeyword) {
+    return Instruction{.mnemonic = mnemonic, .hasQwordKeyword = hasQwordKeyword};
+}
+Instruction makeInstruction(Mnemonic mnemonic, Operand operand, bool hasQwordKeyword) {
+    return Instruction{
+        .mnemonic = mnemonic,
+        .operands = {std::move(operand), Operand{}},
+        .numOperands = 1,
+        .hasQwordKeyword = hasQwordKeyword,
+    };
+}
+Instruction makeInstruction(Mnemonic mnemonic, Operand destination, Operand source, bool hasQwordKeyword) {
+    return Instruction{
+        .mnemonic = mnemonic,
+        .operands = {std::move(destination), std::move(source)},
+        .numOperands = 2,
+        .hasQwordKeyword = hasQwordKeyword,
+    };
+}
+
+std::string toNasm(Operand const& operand) {
+    return std::visit(
+        lambda_overload{
+            [](Register const& x) { return registerName(x.reg, x.size); },
+            // the RSI constants are unsigned, so is their text
+            [](Immediate const& x) { return std::to_string(uint64_t(x.value)); },
+            [](Symbol const& x) { return std::string(x.name); },
+            [](Memory const& x) {
+                std::string text;
+                if (x.sizeKeyword == 8) text += "QWORD ";
+                else if (x.sizeKeyword == 1) text += "BYTE ";
+
+                text += "[";
+                if (x.base) text += registerName(*x.base, 8);
+                text += x.symbol;
+                if (x.displacement) text += (x.base ? "+" : "") + std::to_string(uint64_t(*x.displacement));
+                return text + "]";
+            },
+            [](Invalid const& x) { return x.text; },
+        },
+        operand
+    );
+}
+
+std::string toNasm(Instruction const& instruction) {
+    if (instruction.mnemonic == Mnemonic::LABEL) return toNasm(instruction.operands[0]) + ":";
+
+    std::string text(mnemonicName(instruction.mnemonic));
+    if (instruction.hasQwordKeyword) text += " QWORD";
+    for (uint8_t i = 0; i < instruction.numOperands; i++)
+        text += (i ? ", " : " ") + toNasm(instruction.operands[i]);
+    return text;
+}
+
+} // namespace X86
@@ -0,0 +1,349 @@
+#include "R-Sharp/backend/X86Encoder.hpp"
+#include "R-Sharp/Logging.hpp"
+
+#include <elf.h>
+
+namespace {
+// the number of the register in the instruction encoding
+uint8_t encoding(NasmRegisters reg) {
+    static constexpr uint8_t numbers[] = {0, 3, 1, 2, 6, 7, 5, 4, 8, 9, 10, 11, 12, 13, 14, 15};
+    return numbers[static_cast<int>(reg)];
+}
+
+bool fitsInt8(int64_t value) {
+    return value >= INT8_MIN && value <= INT8_MAX;
+}
+bool fitsInt32(int64_t value) {
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+// spl, bpl, sil and dil can only be addressed with a REX prefix, without one they are ah, ch, dh and bh
+bool needsRexForByte(uint8_t number) {
+    return number >= 4 && number < 8;
+}
+
+// the size an instruction with a memory operand works on, 0 if NASM would complain that it isn't specified
+uint8_t memorySize(X86::Instruction const& instruction, X86::Memory const& memory) {
+    if (instruction.hasQwordKeyword) return 8;
+    return memory.sizeKeyword;
+}
+} // namespace
+
+bool X86Encoder::encode(X86::Instruction const& instruction) {
+    using X86::Mnemonic;
+
+    auto const& operands = instruction.operands;
+    for (uint8_t i = 0; i < instruction.numOperands; i++) {
+        if (std::holds_alternative<X86::Invalid>(operands[i])) return fail(instruction, "invalid operand");
+    }
+
+    switch (instruction.mnemonic) {
+        case Mnemonic::LABEL: {
+            auto label = std::get_if<X86::Symbol>(&operands[0]);
+            if (!label) return fail(instruction, "invalid label");
+            if (!labels.emplace(label->name, code.size()).second) return fail(instruction, "label redefined");
+            return true;
+        }
+
+        case Mnemonic::ADD:  return encodeTwoOperands(instruction, 0x01, 0x03, 0);
+        case Mnemonic::SUB:  return encodeTwoOperands(instruction, 0x29, 0x2B, 5);
+        case Mnemonic::CMP:  return encodeTwoOperands(instruction, 0x39, 0x3B, 7);
+        case Mnemonic::MOV:  return encodeMove(instruction);
+        case Mnemonic::NOT:  return encodeOneOperand(instruction, 2);
+        case Mnemonic::NEG:  return encodeOneOperand(instruction, 3);
+        case Mnemonic::IMUL: return encodeOneOperand(instruction, 5);
+        case Mnemonic::IDIV: return encodeOneOperand(instruction, 7);
+
+        case Mnemonic::CQO:
+            code.insert(code.end(), {0x48, 0x99});
+            return true;
+        case Mnemonic::RET:
+            code.push_back(0xC3);
+            return true;
+
+        case Mnemonic::MOVZX: {
+            auto destination = std::get_if<X86::Register>(&operands[0]);
+            auto source = std::get_if<X86::Register>(&operands[1]);
+            auto sourceMemory = std::get_if<X86::Memory>(&operands[1]);
+            if (!destination || destination->size != 4)
+                return fail(instruction, "only 32 bit destinations are supported");
+            if (!(source && source->size == 1) && !(sourceMemory && sourceMemory->sizeKeyword == 1))
+                return fail(instruction, "only byte sources are supported");
+            return emitModRM({0x0F, 0xB6}, false, encoding(destination->reg), false, operands[1])
+                || fail(instruction, "invalid operand");
+        }
+
+        case Mnemonic::SETE:
+        case Mnemonic::SETNE:
+        case Mnemonic::SETL:
+        case Mnemonic::SETLE:
+        case Mnemonic::SETG:
+        case Mnemonic::SETGE: {
+            uint8_t condition = 0;
+            switch (instruction.mnemonic) {
+                case Mnemonic::SETE:  condition = 0x94; break;
+                case Mnemonic::SETNE: condition = 0x95; break;
+                case Mnemonic::SETL:  condition = 0x9C; break;
+                case Mnemonic::SETLE: condition = 0x9E; break;
+                case Mnemonic::SETG:  condition = 0x9F; break;
+                default:              condition = 0x9D; break;
+            }
+            auto reg = std::get_if<X86::Register>(&operands[0]);
+            auto memory = std::get_if<X86::Memory>(&operands[0]);
+            if (reg && reg->size != 1) return fail(instruction, "setcc only writes byte registers");
+            if (memory && memory->sizeKeyword != 0 && memory->sizeKeyword != 1)
+                return fail(instruction, "setcc only writes single bytes");
+            return emitModRM({0x0F, condition}, false, 0, false, operands[0])
+                || fail(instruction, "invalid operand");
+        }
+
+        case Mnemonic::JMP:
+        case Mnemonic::JE:
+        case Mnemonic::CALL: {
+            auto target = std::get_if<X86::Symbol>(&operands[0]);
+            if (!target) return fail(instruction, "only jumps to labels are supported");
+
+            if (instruction.mnemonic == Mnemonic::JMP) code.push_back(0xE9);
+            else if (instruction.mnemonic == Mnemonic::CALL) code.push_back(0xE8);
+            else code.insert(code.end(), {0x0F, 0x84});
+            branches.push_back(Branch{.offset = code.size(), .target = target->name});
+            emitImmediate(0, 4);
+            return true;
+        }
+
+        case Mnemonic::PUSH:
+        case Mnemonic::POP: {
+            bool isPush = instruction.mnemonic == Mnemonic::PUSH;
+            if (auto reg = std::get_if<X86::Register>(&operands[0])) {
+                if (reg->size != 8) return fail(instruction, "only 64 bit registers are supported");
+                auto number = encoding(reg->reg);
+                if (number & 8) code.push_back(0x41);
+                code.push_back((isPush ? 0x50 : 0x58) + (number & 7));
+                return true;
+            }
+            if (auto memory = std::get_if<X86::Memory>(&operands[0])) {
+                if (memorySize(instruction, *memory) != 8)
+                    return fail(instruction, "operation size not specified");
+                // the operand size defaults to 64 bit, no REX.W needed
+                return emitModRM({uint8_t(isPush ? 0xFF : 0x8F)}, false, isPush ? 6 : 0, false, operands[0])
+                    || fail(instruction, "invalid operand");
+            }
+            if (!isPush) return fail(instruction, "invalid operand");
+
+            if (auto symbol = std::get_if<X86::Symbol>(&operands[0])) {
+                code.push_back(0x68);
+                emitSymbol(symbol->name, R_X86_64_32S, 0, 4);
+                return true;
+            }
+            auto value = std::get<X86::Immediate>(operands[0]).value;
+            if (fitsInt8(value)) {
+                code.push_back(0x6A);
+                emitImmediate(value, 1);
+            }
+            else if (fitsInt32(value)) {
+                code.push_back(0x68);
+                emitImmediate(value, 4);
+            }
+            else return fail(instruction, "the immediate doesn't fit into 32 bits");
+            return true;
+        }
+    }
+    return fail(instruction, "unknown instruction");
+}
+
+bool X86Encoder::encodeTwoOperands(
+    X86::Instruction const& instruction, uint8_t opcodeToMemory, uint8_t opcodeToRegister, uint8_t immediateDigit
+) {
+    auto const& destination = instruction.operands[0];
+    auto const& source = instruction.operands[1];
+
+    auto destinationRegister = std::get_if<X86::Register>(&destination);
+    auto destinationMemory = std::get_if<X86::Memory>(&destination);
+    if (!destinationRegister && !destinationMemory) return fail(instruction, "invalid destination");
+    if (destinationRegister && destinationRegister->size != 8)
+        return fail(instruction, "only 64 bit registers are supported");
+
+    if (auto reg = std::get_if<X86::Register>(&source)) {
+        if (reg->size != 8) return fail(instruction, "only 64 bit registers are supported");
+        return emitModRM({opcodeToMemory}, true, encoding(reg->reg), false, destination)
+            || fail(instruction, "invalid operand");
+    }
+    if (X86::isMemory(source)) {
+        if (!destinationRegister) return fail(instruction, "invalid combination of opcode and operands");
+        return emitModRM({opcodeToRegister}, true, encoding(destinationRegister->reg), false, source)
+            || fail(instruction, "invalid operand");
+    }
+
+    if (destinationMemory && memorySize(instruction, *destinationMemory) != 8)
+        return fail(instruction, "operation size not specified");
+
+    if (auto symbol = std::get_if<X86::Symbol>(&source)) {
+        if (!emitModRM({0x81}, true, immediateDigit, false, destination, 4))
+            return fail(instruction, "invalid operand");
+        emitSymbol(symbol->name, R_X86_64_32S, 0, 4);
+        return true;
+    }
+    auto value = std::get<X86::Immediate>(source).value;
+    if (fitsInt8(value)) {
+        if (!emitModRM({0x83}, true, immediateDigit, false, destination, 1))
+            return fail(instruction, "invalid operand");
+        emitImmediate(value, 1);
+        return true;
+    }
+    if (fitsInt32(value)) {
+        if (!emitModRM({0x81}, true, immediateDigit, false, destination, 4))
+            return fail(instruction, "invalid operand");
+        emitImmediate(value, 4);
+        return true;
+    }
+    return fail(instruction, "the immediate doesn't fit into 32 bits");
+}
+
+bool X86Encoder::encodeMove(X86::Instruction const& instruction) {
+    auto const& destination = instruction.operands[0];
+    auto const& source = instruction.operands[1];
+    if (std::holds_alternative<X86::Register>(source) || X86::isMemory(source))
+        return encodeTwoOperands(instruction, 0x89, 0x8B, 0);
+
+    auto reg = std::get_if<X86::Register>(&destination);
+    auto memory = std::get_if<X86::Memory>(&destination);
+    if (!reg && !memory) return fail(instruction, "invalid destination");
+    if (reg && reg->size != 8) return fail(instruction, "only 64 bit registers are supported");
+    if (memory && memorySize(instruction, *memory) != 8)
+        return fail(instruction, "operation size not specified");
+
+    if (auto symbol = std::get_if<X86::Symbol>(&source)) {
+        if (!emitModRM({0xC7}, true, 0, false, destination, 4)) return fail(instruction, "invalid operand");
+        emitSymbol(symbol->name, R_X86_64_32S, 0, 4);
+        return true;
+    }
+
+    auto value = std::get<X86::Immediate>(source).value;
+    if (reg && value >= 0 && value <= UINT32_MAX) {
+        // writing the lower half of a register clears the upper one
+        auto number = encoding(reg->reg);
+        if (number & 8) code.push_back(0x41);
+        code.push_back(0xB8 + (number & 7));
+        emitImmediate(value, 4);
+        return true;
+    }
+    if (fitsInt32(value)) {
+        // sign extended to 64 bit
+        if (!emitModRM({0xC7}, true, 0, false, destination, 4)) return fail(instruction, "invalid operand");
+        emitImmediate(value, 4);
+        return true;
+    }
+    if (!reg) return fail(instruction, "the immediate doesn't fit into 32 bits");
+
+    auto number = encoding(reg->reg);
+    code.push_back(number & 8 ? 0x49 : 0x48);
+    code.push_back(0xB8 + (number & 7));
+    emitImmediate(value, 8);
+    return true;
+}
+
+bool X86Encoder::encodeOneOperand(X86::Instruction const& instruction, uint8_t digit) {
+    auto const& operand = instruction.operands[0];
+    if (auto reg = std::get_if<X86::Register>(&operand); reg && reg->size != 8)
+        return fail(instruction, "only 64 bit registers are supported");
+    if (auto memory = std::get_if<X86::Memory>(&operand); memory && memorySize(instruction, *memory) != 8)
+        return fail(instruction, "operation size not specified");
+
+    return emitModRM({0xF7}, true, digit, false, operand) || fail(instruction, "invalid operand");
+}
+
+bool X86Encoder::emitModRM(
+    std::initializer_list<uint8_t> opcode,
+    bool is64Bit,
+    uint8_t reg,
+    bool regIsByte,
+    X86::Operand const& rm,
+    size_t immediateSize
+) {
+    uint8_t rex = is64Bit ? 0x48 : 0;
+    if (reg & 8) rex |= 0x44;
+    if (regIsByte && needsRexForByte(reg)) rex |= 0x40;
+
+    const auto emitOpcode = [&]() {
+        if (rex) code.push_back(rex);
+        code.insert(code.end(), opcode);
+    };
+
+    if (auto rmRegister = std::get_if<X86::Register>(&rm)) {
+        auto number = encoding(rmRegister->reg);
+        if (number & 8) rex |= 0x41;
+        if (rmRegister->size == 1 && needsRexForByte(number)) rex |= 0x40;
+
+        emitOpcode();
+        code.push_back(0xC0 | (reg & 7) << 3 | (number & 7));
+        return true;
+    }
+
+    auto memory = std::get_if<X86::Memory>(&rm);
+    if (!memory) return false;
+    int64_t displacement = memory->displacement.value_or(0);
+    if (!fitsInt32(displacement) || (memory->base && !memory->symbol.empty())) return false;
+
+    if (memory->base) {
+        auto base = encoding(*memory->base);
+        if (base & 8) rex |= 0x41;
+
+        // rbp and r13 without displacement would mean rip relative
+        uint8_t mod = displacement == 0 && (base & 7) != 5 ? 0 : fitsInt8(displacement) ? 1 : 2;
+        emitOpcode();
+        code.push_back(mod << 6 | (reg & 7) << 3 | (base & 7));
+        // rsp and r12 need a SIB byte
+        if ((base & 7) == 4) code.push_back(0x24);
+        if (mod == 1) emitImmediate(displacement, 1);
+        else if (mod == 2) emitImmediate(displacement, 4);
+        return true;
+    }
+
+    emitOpcode();
+    if (!memory->symbol.empty()) {
+        code.push_back((reg & 7) << 3 | 5);
+        // relative to the end of the instruction, which is behind the immediate
+        emitSymbol(memory->symbol, R_X86_64_PC32, displacement - 4 - int64_t(immediateSize), 4);
+        return true;
+    }
+    // an absolute address
+    code.push_back((reg & 7) << 3 | 4);
+    code.push_back(0x25);
+    emitImmediate(displacement, 4);
+    return true;
+}
+
+void X86Encoder::emitImmediate(int64_t value, size_t size) {
+    for (size_t i = 0; i < size; i++)
+        code.push_back(uint8_t(uint64_t(value) >> (8 * i)));
+}
+
+void X86Encoder::emitSymbol(std::string_view symbol, uint32_t type, int64_t addend, size_t size) {
+    relocations.push_back(Relocation{.offset = code.size(), .symbol = symbol, .type = type, .addend = addend});
+    emitImmediate(0, size);
+}
+
+void X86Encoder::finish() {
+    for (auto const& branch : branches) {
+        auto label = labels.find(branch.target);
+        if (label == labels.end()) {
+            relocations.push_back(Relocation{
+                .offset = branch.offset,
+                .symbol = branch.target,
+                .type = R_X86_64_PLT32,
+                .addend = -4,
+            });
+            continue;
+        }
+
+        int64_t displacement = int64_t(label->second) - int64_t(branch.offset + 4);
+        for (size_t i = 0; i < 4; i++)
+            code[branch.offset + i] = uint8_t(uint64_t(displacement) >> (8 * i));
+    }
+    branches.clear();
+}
+
+bool X86Encoder::fail(X86::Instruction const& instruction, std::string_view reason) const {
+    Error("Can't encode \"", X86::toNasm(instruction), "\": ", reason);
+    return false;
+}
@@ -0,0 +1,122 @@
+#include "R-Sharp/frontend/CharacterScanning.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+template <bool (*predicate)(char)>
+size_t spanScalar(std::string_view text, size_t start = 0) {
+    size_t i = start;
+    while (i < text.size() && predicate(text[i]))
+        i++;
+    return i;
+}
+
+struct Spanners {
+    size_t (*whitespace)(std::string_view);
+    size_t (*identifierCharacters)(std::string_view);
+    size_t (*digits)(std::string_view);
+};
+
+#if defined(__SSE2__)
+
+// characters are compared signed, so bytes above 127 never fall into an ASCII range
+inline __m128i inRange(__m128i chunk, char low, char high) {
+    return _mm_and_si128(
+        _mm_cmpgt_epi8(chunk, _mm_set1_epi8(low - 1)), _mm_cmplt_epi8(chunk, _mm_set1_epi8(high + 1))
+    );
+}
+
+inline __m128i whitespaceMask(__m128i chunk) {
+    return _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), inRange(chunk, '\t', '\r'));
+}
+inline __m128i digitMask(__m128i chunk) {
+    return inRange(chunk, '0', '9');
+}
+inline __m128i identifierMask(__m128i chunk) {
+    // setting bit 5 maps upper case letters to lower case ones
+    auto letters = inRange(_mm_or_si128(chunk, _mm_set1_epi8(0x20)), 'a', 'z');
+    auto underscores = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(letters, underscores), digitMask(chunk));
+}
+
+template <__m128i (*mask)(__m128i), bool (*predicate)(char)>
+size_t spanSSE2(std::string_view text) {
+    size_t i = 0;
+    for (; i + 16 <= text.size(); i += 16) {
+        auto chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(text.data() + i));
+        unsigned matches = _mm_movemask_epi8(mask(chunk));
+        if (matches != 0xffff) return i + __builtin_ctz(~matches);
+    }
+    return spanScalar<predicate>(text, i);
+}
+
+__attribute__((target("avx2"))) inline __m256i inRange256(__m256i chunk, char low, char high) {
+    return _mm256_and_si256(
+        _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(low - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(high + 1), chunk)
+    );
+}
+
+__attribute__((target("avx2"))) inline __m256i whitespaceMask256(__m256i chunk) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), inRange256(chunk, '\t', '\r'));
+}
+__attribute__((target("avx2"))) inline __m256i digitMask256(__m256i chunk) {
+    return inRange256(chunk, '0', '9');
+}
+__attribute__((target("avx2"))) inline __m256i identifierMask256(__m256i chunk) {
+    auto letters = inRange256(_mm256_or_si256(chunk, _mm256_set1_epi8(0x20)), 'a', 'z');
+    auto underscores = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('_'));
+    return _mm256_or_si256(_mm256_or_si256(letters, underscores), digitMask256(chunk));
+}
+
+template <__m256i (*mask)(__m256i), bool (*predicate)(char)>
+__attribute__((target("avx2"))) size_t spanAVX2(std::string_view text) {
+    size_t i = 0;
+    for (; i + 32 <= text.size(); i += 32) {
+        auto chunk = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(text.data() + i));
+        unsigned matches = _mm256_movemask_epi8(mask(chunk));
+        if (matches != 0xffffffff) return i + __builtin_ctz(~matches);
+    }
+    return spanScalar<predicate>(text, i);
+}
+
+Spanners const spanners = []() {
+    // this runs during static initialization, the cpu model might not be set up yet
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Spanners{
+            .whitespace = spanAVX2<whitespaceMask256, isWhitespace>,
+            .identifierCharacters = spanAVX2<identifierMask256, isIdentifierCharacter>,
+            .digits = spanAVX2<digitMask256, isDigit>,
+        };
+    }
+    return Spanners{
+        .whitespace = spanSSE2<whitespaceMask, isWhitespace>,
+        .identifierCharacters = spanSSE2<identifierMask, isIdentifierCharacter>,
+        .digits = spanSSE2<digitMask, isDigit>,
+    };
+}();
+
+#else
+
+Spanners const spanners = {
+    .whitespace = [](std::string_view text) { return spanScalar<isWhitespace>(text); },
+    .identifierCharacters = [](std::string_view text) { return spanScalar<isIdentifierCharacter>(text); },
+    .digits = [](std::string_view text) { return spanScalar<isDigit>(text); },
+};
+
+#endif
+
+}
+
+size_t spanWhitespace(std::string_view text) {
+    return spanners.whitespace(text);
+}
+size_t spanIdentifierCharacters(std::string_view text) {
+    return spanners.identifierCharacters(text);
+}
+size_t spanDigits(std::string_view text) {
+    return spanners.digits(text);
+}
@@ -1,41 +1,156 @@
 #include "R-Sharp/frontend/Parser.hpp"
 #include "R-Sharp/ast/AstNodesFWD.hpp"
 #include "R-Sharp/frontend/Tokenizer.hpp"
+#include "R-Sharp/Utils/ThreadPool.hpp"
+#include "R-Sharp/Utils/Trace.hpp"
 
 #include <filesystem>
 #include <memory>
 
+#include <unistd.h>
+
+namespace {
+// how tightly a binary operator binds, 0 for tokens that aren't binary operators
+int binaryPrecedence(TokenType type) {
+    switch (type) {
+        case TokenType::DoublePipe:       return 1;
+        case TokenType::DoubleAmpersand:  return 2;
+        case TokenType::EqualEqual:
+        case TokenType::NotEqual:         return 3;
+        case TokenType::GreaterThan:
+        case TokenType::GreaterThanEqual:
+        case TokenType::LessThan:
+        case TokenType::LessThanEqual:    return 4;
+        case TokenType::Plus:
+        case TokenType::Minus:            return 5;
+        case TokenType::Star:
+        case TokenType::Slash:
+        case TokenType::Percent:          return 6;
+        default:                          return 0;
+    }
+}
+
+std::string_view getProgramItemName(std::shared_ptr<AstProgramItem> const& item) {
+    switch (item->getType()) {
+        case AstNodeType::AstFunctionDefinition:
+            return std::static_pointer_cast<AstFunctionDefinition>(item)->name;
+        case AstNodeType::AstVariableDeclaration:
+            return std::static_pointer_cast<AstVariableDeclaration>(item)->name;
+        default: return "";
+    }
+}
+}
+
 Parser::Parser(std::vector<Token> const& tokens, std::string const& filename, std::string const& importSearchPath, ParsingCache& cache)
     : tokens(tokens), filename(filename), importSearchPath(importSearchPath), cache(cache) {
-    program = std::make_shared<AstProgram>();
+    program = makeNode<AstProgram>();
 }
 
 std::shared_ptr<AstProgram> Parser::parse() {
-    cache.addWildcard(filename);
+    return parse(parseSyntax());
+}
+std::shared_ptr<AstProgram> Parser::parse(ParsingCache::ParsedFile file) {
+    cache.addModule(filename);
+    Verbose("Parsing ", std::filesystem::absolute(filename));
+    hasError = file.hasErrors;
+
+    // put the imported items in between the file's own ones
+    auto const& ownItems = file.program->items;
+    std::vector<std::shared_ptr<AstProgramItem>> items;
+    size_t next = 0;
+    for (auto const& import : file.imports) {
+        items.insert(items.end(), ownItems.begin() + next, ownItems.begin() + import.position);
+        next = import.position;
+        auto importedItems = resolveImport(import);
+        items.insert(items.end(), importedItems.begin(), importedItems.end());
+    }
+    items.insert(items.end(), ownItems.begin() + next, ownItems.end());
+
+    program = file.program;
+    program->items = std::move(items);
+
+    auto& module = cache.addModule(filename);
+    module.items = program->items;
+    module.hasErrors = hasError;
+    module.isParsed = true;
+    return program;
+}
+ParsingCache::ParsedFile Parser::parseSyntax() {
     hasError = false;
     isRecovering = false;
-    Print("Parsing ", std::filesystem::absolute(filename));
-    auto prog = parseProgram();
-    return prog;
+    parseProgram();
+    return ParsingCache::ParsedFile{
+        .program = program,
+        .imports = std::move(imports),
+        .hasErrors = hasError,
+    };
+}
+
+void Parser::preloadImports(ThreadPool& threadPool) {
+    cache.reservePreload(filename);
+    scheduleImports(tokens, filename, importSearchPath, cache, threadPool);
+    threadPool.wait();
+}
+void Parser::scheduleImports(
+    std::vector<Token> const& tokens,
+    std::string const& filename,
+    std::string const& importSearchPath,
+    ParsingCache& cache,
+    ThreadPool& threadPool
+) {
+    // "@" only appears in imports, it is followed by the path: "@ name::name;"
+    for (size_t i = 0; i < tokens.size(); i++) {
+        if (tokens[i].type != TokenType::At) continue;
+
+        std::vector<std::string_view> importPath;
+        for (size_t j = i + 1; j < tokens.size() && tokens[j].type == TokenType::Identifier; j += 2) {
+            importPath.push_back(tokens[j].value);
+            if (j + 1 >= tokens.size() || tokens[j + 1].type != TokenType::DoubleColon) break;
+        }
+        if (importPath.empty()) continue;
+
+        auto path = getImportFilePath(importPath, filename, importSearchPath);
+        if (cache.reservePreload(path)) {
+            threadPool.submit([path, importSearchPath, &cache, &threadPool]() {
+                preloadFile(path, importSearchPath, cache, threadPool);
+            });
+        }
+    }
+}
+void Parser::preloadFile(
+    std::string const& filename, std::string const& importSearchPath, ParsingCache& cache, ThreadPool& threadPool
+) {
+    // errors are left to parse(), it reports them once the file is actually imported
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(filename, error) || access(filename.c_str(), R_OK) != 0) return;
+
+    std::vector<Token> tokens;
+    {
+        auto event = Trace::get().event("Tokenize", filename);
+        Tokenizer tokenizer(filename);
+        tokens = tokenizer.tokenizeQuietly();
+        if (!tokenizer.getErrors().empty()) return;
+    }
+
+    scheduleImports(tokens, filename, importSearchPath, cache, threadPool);
+
+    auto event = Trace::get().event("Parse", filename);
+    Parser parser(tokens, filename, importSearchPath, cache);
+    cache.addParsedFile(filename, parser.parseSyntax());
 }
 
 
+
 bool Parser::match(TokenType type) const {
     return !isAtEnd() && getCurrentToken().type == type;
 }
 bool Parser::match(TokenType type, std::string value) const {
     return !isAtEnd() && getCurrentToken().type == type && getCurrentToken().value == value;
 }
-bool Parser::match(std::vector<TokenType> types) const {
-    if (isAtEnd(types.size() - 1))
-        return false;
-    for (int i = 0; i < types.size(); i++) {
-        if (getToken(i).type != types[i])
-            return false;
-    }
-    return true;
+bool Parser::match(std::initializer_list<TokenType> types) const {
+    return match(0, types);
 }
-bool Parser::matchAny(std::vector<TokenType> types) const {
+bool Parser::matchAny(std::initializer_list<TokenType> types) const {
     for (TokenType type : types) {
         if (match(type)) {
             return true;
@@ -50,16 +165,16 @@ bool Parser::match(int offset, TokenType type) const {
 bool Parser::match(int offset, TokenType type, std::string value) const {
     return !isAtEnd(offset) && getToken(offset).type == type && getToken(offset).value == value;
 }
-bool Parser::match(int offset, std::vector<TokenType> types) const {
+bool Parser::match(int offset, std::initializer_list<TokenType> types) const {
     if (isAtEnd(offset + types.size() - 1))
         return false;
-    for (int i = 0; i < types.size(); i++) {
-        if (getToken(offset + i).type != types[i])
+    for (TokenType type : types) {
+        if (getToken(offset++).type != type)
             return false;
     }
     return true;
 }
-bool Parser::matchAny(int offset, std::vector<TokenType> types) const {
+bool Parser::matchAny(int offset, std::initializer_list<TokenType> types) const {
     for (TokenType type : types) {
         if (match(offset, type)) {
             return true;
@@ -84,26 +199,26 @@ Token Parser::consume(TokenType type, std::string value) {
         parserError("Expected ", Token(type, value).toString(), " but got ", getCurrentToken().toString());
     return consume();
 }
-Token Parser::consume(std::vector<TokenType> types) {
-    for (int i = 0; i < types.size(); i++) {
-        if (!match(types[i])) {
-            parserError("Expected ", tokenTypeToString(types[i]), " but got ", getCurrentToken().toString());
+Token Parser::consume(std::initializer_list<TokenType> types) {
+    for (TokenType type : types) {
+        if (!match(type)) {
+            parserError("Expected ", tokenTypeToString(type), " but got ", getCurrentToken().toString());
         }
         consume();
     }
     return getCurrentToken();
 }
-Token Parser::consumeAnyOne(std::vector<TokenType> types) {
+Token Parser::consumeAnyOne(std::initializer_list<TokenType> types) {
     for (TokenType type : types) {
         if (match(type)) {
             return consume();
         }
     }
     std::string error = "Expected one of ";
-    for (int i = 0; i < types.size(); i++) {
-        error += tokenTypeToString(types[i]);
-        if (i != types.size() - 1)
+    for (TokenType type : types) {
+        if (type != *types.begin())
             error += ", ";
+        error += tokenTypeToString(type);
     }
     parserError(error, " but got ", getCurrentToken().toString());
     return getCurrentToken();
@@ -125,6 +240,33 @@ Token Parser::getToken(int offset) const {
         return Token(TokenType::EndOfFile, "");
     return tokens[currentTokenIndex + offset];
 }
+TokenType Parser::getTokenType(int offset) const {
+    if (isAtEnd(offset))
+        return TokenType::EndOfFile;
+    return tokens[currentTokenIndex + offset].type;
+}
+
+bool Parser::isExpressionStart() const {
+    switch (getTokenType()) {
+        case TokenType::Bang:
+        case TokenType::Minus:
+        case TokenType::Tilde:
+        case TokenType::DollarSign:
+        case TokenType::Star:
+        case TokenType::LeftParen:
+        case TokenType::LeftBracket:
+        case TokenType::Number:
+        case TokenType::CharacterLiteral:
+        case TokenType::StringLiteral:
+        case TokenType::Identifier:       return true;
+        default:                          return false;
+    }
+}
+bool Parser::isImportStatementStart() const {
+    // "* @ ..." or "name, other @ ..."
+    return match(TokenType::Star) || match({TokenType::Identifier, TokenType::Comma})
+        || match({TokenType::Identifier, TokenType::At});
+}
 
 
 std::shared_ptr<AstProgram> Parser::parseProgram() {
@@ -134,22 +276,29 @@ std::shared_ptr<AstProgram> Parser::parseProgram() {
         while (match(TokenType::Comment))
             consume(TokenType::Comment);
 
-        try {
-            auto ckpt = getTokenCheckpoint();
-            auto importedThings = parseImportStatement();
-            program->items.insert(program->items.end(), importedThings.begin(), importedThings.end());
-        }
-        catch (ParsingError) {
-            auto item = parseProgramItem();
-
-            if (item->getType() == AstNodeType::AstErrorProgramItem && !wereRecovering) {
-                program->items.push_back(item);
+        std::shared_ptr<AstProgramItem> item;
+        if (isImportStatementStart()) {
+            try {
+                auto import = parseImportStatement();
+                import.position = program->items.size();
+                imports.push_back(std::move(import));
+                continue;
             }
-            else if (item->getType() != AstNodeType::AstErrorProgramItem) {
-                program->items.push_back(item);
-                isRecovering = false;
+            catch (ParsingError const& e) {
+                item = makeProgramItemError(e);
             }
         }
+        else {
+            item = parseProgramItem();
+        }
+
+        if (item->getType() == AstNodeType::AstErrorProgramItem && !wereRecovering) {
+            program->items.push_back(item);
+        }
+        else if (item->getType() != AstNodeType::AstErrorProgramItem) {
+            program->items.push_back(item);
+            isRecovering = false;
+        }
     }
     return program;
 }
@@ -165,19 +314,22 @@ std::shared_ptr<AstProgramItem> Parser::parseProgramItem() {
         }
     }
     catch (ParsingError const& e) {
-        hasError = true;
-        // consume one token to try to recover
-        if (isRecovering) {
-            consume();
-        }
-        isRecovering = true;
-        auto err = std::make_shared<AstErrorProgramItem>(e.what());
-        err->token = getCurrentToken();
-        return err;
+        return makeProgramItemError(e);
+    }
+}
+std::shared_ptr<AstErrorProgramItem> Parser::makeProgramItemError(ParsingError const& error) {
+    hasError = true;
+    // consume one token to try to recover
+    if (isRecovering) {
+        consume();
     }
+    isRecovering = true;
+    auto err = makeNode<AstErrorProgramItem>(error.what());
+    err->token = getCurrentToken();
+    return err;
 }
 std::shared_ptr<AstFunctionDefinition> Parser::parseFunctionDefinition() {
-    auto function = std::make_shared<AstFunctionDefinition>();
+    auto function = makeNode<AstFunctionDefinition>();
     function->tags = parseTags();
     function->token = consume(TokenType::ID);
     function->name = function->token.value;
@@ -187,7 +339,7 @@ std::shared_ptr<AstFunctionDefinition> Parser::parseFunctionDefinition() {
     function->semanticType = parseType();
 
 
-    function->functionData = std::make_shared<SemanticFunctionData>();
+    function->functionData = makeNode<SemanticFunctionData>();
     function->functionData->name = function->name;
     function->functionData->returnType = function->semanticType;
     function->functionData->parameters = function->parameters;
@@ -203,7 +355,7 @@ std::shared_ptr<AstFunctionDefinition> Parser::parseFunctionDefinition() {
         if (body->getType() == AstNodeType::AstBlock)
             function->body = std::dynamic_pointer_cast<AstBlock>(body);
         else {
-            function->body = std::make_shared<AstBlock>();
+            function->body = makeNode<AstBlock>();
             function->body->items.push_back(body);
         }
     }
@@ -214,62 +366,70 @@ std::shared_ptr<AstFunctionDefinition> Parser::parseFunctionDefinition() {
 }
 std::shared_ptr<AstVariableDeclaration> Parser::parseGlobalVariableDefinition() {
     auto var = parseVariableDeclaration();
-    var->variable = std::make_shared<SemanticVariableData>();
+    var->variable = makeNode<SemanticVariableData>();
     var->variable->isGlobal = true;
     var->variable->name = var->name;
     consume(TokenType::Semicolon);
     return var;
 }
-std::vector<std::shared_ptr<AstProgramItem>> Parser::parseImportStatement() {
-    bool importEverything = false;
-
-    std::vector<Token> identifiersToImport = {};
+ParsingCache::Import Parser::parseImportStatement() {
+    ParsingCache::Import import;
 
     if (match(TokenType::Star)) {
         consume(TokenType::Star);
-        importEverything = true;
+        import.importEverything = true;
     }
     else {
-        identifiersToImport.push_back(consume(TokenType::Identifier));
+        import.identifiers.push_back(consume(TokenType::Identifier));
         while (match(TokenType::Comma)) {
             consume(TokenType::Comma);
-            identifiersToImport.push_back(consume(TokenType::Identifier));
+            import.identifiers.push_back(consume(TokenType::Identifier));
         }
     }
 
     consume(TokenType::At);
 
-    std::vector<Token> importPath = {};
-    importPath.push_back(consume(TokenType::Identifier));
+    std::vector<std::string_view> importPath = {};
+    importPath.push_back(consume(TokenType::Identifier).value);
     while (match(TokenType::DoubleColon)) {
         consume(TokenType::DoubleColon);
-        importPath.push_back(consume(TokenType::Identifier));
+        importPath.push_back(consume(TokenType::Identifier).value);
     }
     consume(TokenType::Semicolon);
 
-    // preprocessing
-
+    import.path = getImportFilePath(importPath, filename, importSearchPath);
+    return import;
+}
+std::string Parser::getImportFilePath(
+    std::vector<std::string_view> importPath, std::string const& importingFile, std::string const& importSearchPath
+) {
     std::string path;
-    if (importPath.at(0).value == "std")
-        importPath.at(0).value = importSearchPath;
+    if (importPath.at(0) == "std")
+        importPath.at(0) = importSearchPath;
     else {
-        path = std::filesystem::absolute(filename).remove_filename();
+        path = std::filesystem::absolute(importingFile).remove_filename();
     }
 
-    for (auto tok : importPath) {
-        path += tok.value + "/";
+    for (auto part : importPath) {
+        path += part;
+        path += "/";
     }
     // remove the trailing slash
     path = path.substr(0, path.size() - 1);
     path += ".rs";
-    path = std::filesystem::absolute(path);
+    return std::filesystem::absolute(path);
+}
+std::vector<std::shared_ptr<AstProgramItem>> Parser::resolveImport(ParsingCache::Import const& import) {
+    auto const& path = import.path;
+    const bool importEverything = import.importEverything;
+    std::vector<Token> identifiersToImport = import.identifiers;
 
     if (!identifiersToImport.empty()) {
         identifiersToImport.erase(
             std::remove_if(
                 identifiersToImport.begin(),
                 identifiersToImport.end(),
-                [&](auto const& ident) { return cache.contains(path, ident.value); }
+                [&](auto const& ident) { return cache.contains(path, std::string(ident.value)); }
             ),
             identifiersToImport.end()
         );
@@ -291,44 +451,59 @@ std::vector<std::shared_ptr<AstProgramItem>> Parser::parseImportStatement() {
     }
 
 
-    // Tokenize and parse
-    Tokenizer tokenizer(path);
-    auto tokens = tokenizer.tokenize();
-    Parser parser(tokens, path, importSearchPath, cache);
-    auto importedRoot = parser.parse();
+    auto module = cache.getModule(path);
+    if (!module) {
+        auto event = Trace::get().event("Resolve import", path);
+        if (auto parsedFile = cache.takeParsedFile(path)) {
+            Parser parser({}, path, importSearchPath, cache);
+            parser.parse(std::move(*parsedFile));
+        }
+        else {
+            // Tokenize and parse
+            Tokenizer tokenizer(path);
+            auto tokens = tokenizer.tokenize();
+            Parser parser(tokens, path, importSearchPath, cache);
+            parser.parse();
+        }
 
-    if (parser.hasErrors()) {
+        module = cache.getModule(path);
+        if (module->hasErrors) {
+            hasError = true;
+            return module->items;
+        }
+    }
+    else if (!module->isParsed) {
+        // the file imports itself, directly or through other files
+        return {};
+    }
+    else if (module->hasErrors) {
+        // the errors were reported when the file was parsed
         hasError = true;
-        return importedRoot->items;
+        return {};
     }
 
     if (importEverything) {
-        return importedRoot->items;
+        // leave out what was imported by name before
+        std::vector<std::shared_ptr<AstProgramItem>> importedItems;
+        for (auto const& item : module->items) {
+            if (!cache.containsNonWildcard(path, std::string(getProgramItemName(item)))) {
+                importedItems.push_back(item);
+            }
+        }
+        return importedItems;
     }
 
 
     std::vector<std::shared_ptr<AstProgramItem>> importedItems;
 
     for (auto ident : identifiersToImport) {
-        const auto filterForName = [&](auto other) {
-            if (other->getType() == AstNodeType::AstFunctionDefinition) {
-                auto func = std::static_pointer_cast<AstFunctionDefinition>(other);
-                return func->name == ident.value;
-            }
-            else if (other->getType() == AstNodeType::AstVariableDeclaration) {
-                auto var = std::static_pointer_cast<AstVariableDeclaration>(other);
-                return var->name == ident.value;
-            }
-            else {
-                return false;
-            }
-        };
-        if (cache.containsNonWildcard(path, ident.value)) {
+        const auto filterForName = [&](auto const& other) { return getProgramItemName(other) == ident.value; };
+        if (cache.containsNonWildcard(path, std::string(ident.value))) {
             continue;
         }
-        auto item = std::find_if(importedRoot->items.begin(), importedRoot->items.end(), filterForName);
-        if (item == importedRoot->items.end()) {
-            auto error = std::make_shared<AstErrorProgramItem>(
+        auto item = std::find_if(module->items.begin(), module->items.end(), filterForName);
+        if (item == module->items.end()) {
+            auto error = makeNode<AstErrorProgramItem>(
                 stringify("Cannot find program item named '", ident.value, "' in ", std::filesystem::absolute(path))
             );
             error->token = ident;
@@ -336,7 +511,7 @@ std::vector<std::shared_ptr<AstProgramItem>> Parser::parseImportStatement() {
             hasError = true;
         }
         else {
-            cache.add(path, ident.value);
+            cache.add(path, std::string(ident.value));
             importedItems.push_back(*item);
         }
     }
@@ -348,42 +523,22 @@ std::shared_ptr<AstStatement> Parser::parseStatement() {
     // If an error occurs, the parser will try to recover by skipping this statement and returning an error
     // statement.
     try {
-        if (match(TokenType::LeftBrace)) {
-            return parseBlock();
-        }
-        else if (match(TokenType::Return)) {
-            return parseReturn();
-        }
-        else if (match(TokenType::If)) {
-            return parseConditionalStatement();
-        }
-        else if (match(TokenType::While)) {
-            return parseWhileLoop();
-        }
-        else if (match(TokenType::Do)) {
-            return parseDoWhileLoop();
-        }
-        else if (match(TokenType::For)) {
-            try {
-                auto ckpt = getTokenCheckpoint();
-                return parseForLoopDeclaration();
-            }
-            catch (ParsingError const& e) {
-                return parseForLoopExpression();
+        switch (getTokenType()) {
+            case TokenType::LeftBrace: return parseBlock();
+            case TokenType::Return:    return parseReturn();
+            case TokenType::If:        return parseConditionalStatement();
+            case TokenType::While:     return parseWhileLoop();
+            case TokenType::Do:        return parseDoWhileLoop();
+            case TokenType::For:       return parseForLoop();
+            case TokenType::Break:     return parseBreak();
+            case TokenType::Skip:      return parseSkip();
+            default:                   {
+                auto exp = parseOptionalExpression();
+                auto stmt = makeNode<AstExpressionStatement>(exp);
+                stmt->token = consume(TokenType::Semicolon);
+                return stmt;
             }
         }
-        else if (match(TokenType::Break)) {
-            return parseBreak();
-        }
-        else if (match(TokenType::Skip)) {
-            return parseSkip();
-        }
-        else {
-            auto exp = parseOptionalExpression();
-            auto stmt = std::make_shared<AstExpressionStatement>(exp);
-            stmt->token = consume(TokenType::Semicolon);
-            return stmt;
-        }
     }
     catch (ParsingError const& e) {
         hasError = true;
@@ -392,24 +547,23 @@ std::shared_ptr<AstStatement> Parser::parseStatement() {
             consume();
         }
         isRecovering = true;
-        auto err = std::make_shared<AstErrorStatement>(e.what());
+        auto err = makeNode<AstErrorStatement>(e.what());
         err->token = getCurrentToken();
         return err;
     }
 }
 std::shared_ptr<AstExpression> Parser::parseExpression() {
-    try {
-        auto ckpt = getTokenCheckpoint();
-        return parseAssignment();
-    }
-    catch (ParsingError) {
-        return parseConditionalExpression();
+    // both an assignment and a conditional expression start with a prefix expression
+    auto operand = parsePrefixExp();
+    if (match(TokenType::Assign)) {
+        return parseAssignment(operand);
     }
+    return parseConditionalExpression(operand);
 }
 std::shared_ptr<AstDeclaration> Parser::parseDeclaration() {
     if (match({TokenType::ID, TokenType::Colon})) {
         auto decl = parseVariableDeclaration();
-        decl->variable = std::make_shared<SemanticVariableData>();
+        decl->variable = makeNode<SemanticVariableData>();
         decl->variable->name = decl->name;
         decl->variable->type = decl->semanticType;
         consume(TokenType::Semicolon);
@@ -432,22 +586,13 @@ std::shared_ptr<AstBlockItem> Parser::parseBlockItem() {
 
 
 std::shared_ptr<AstReturn> Parser::parseReturn() {
-    std::shared_ptr<AstReturn> returnStatement = std::make_shared<AstReturn>(consume(TokenType::Return));
-    try {
-        auto ckpt = getTokenCheckpoint();
-        returnStatement->value = parseOptionalExpression();
-        consume(TokenType::Semicolon);
-    }
-    catch (ParsingError) {
-        // it is neither an expression nor a simple "return;". still try to parse an expression for a proper
-        // error
-        returnStatement->value = parseExpression();
-        consume(TokenType::Semicolon);
-    }
+    std::shared_ptr<AstReturn> returnStatement = makeNode<AstReturn>(consume(TokenType::Return));
+    returnStatement->value = parseOptionalExpression();
+    consume(TokenType::Semicolon);
     return returnStatement;
 }
 std::shared_ptr<AstBlock> Parser::parseBlock() {
-    std::shared_ptr<AstBlock> block = std::make_shared<AstBlock>();
+    std::shared_ptr<AstBlock> block = makeNode<AstBlock>();
     consume(TokenType::LeftBrace);
     while (!match(TokenType::RightBrace) && !isAtEnd()) {
         bool wereRecovering = isRecovering;
@@ -466,7 +611,7 @@ std::shared_ptr<AstBlock> Parser::parseBlock() {
     return block;
 }
 std::shared_ptr<AstConditionalStatement> Parser::parseConditionalStatement() {
-    std::shared_ptr<AstConditionalStatement> main_conditional = std::make_shared<AstConditionalStatement>(consume(TokenType::If));
+    std::shared_ptr<AstConditionalStatement> main_conditional = makeNode<AstConditionalStatement>(consume(TokenType::If));
     auto current_conditional = main_conditional;
 
     consume(TokenType::LeftParen);
@@ -476,7 +621,7 @@ std::shared_ptr<AstConditionalStatement> Parser::parseConditionalStatement() {
 
     while (match(TokenType::Elif)) {
         consume(TokenType::Elif);
-        current_conditional->falseStatement = std::make_shared<AstConditionalStatement>();
+        current_conditional->falseStatement = makeNode<AstConditionalStatement>();
         current_conditional = std::dynamic_pointer_cast<AstConditionalStatement>(current_conditional->falseStatement);
         consume(TokenType::LeftParen);
         current_conditional->condition = parseExpression();
@@ -492,7 +637,7 @@ std::shared_ptr<AstConditionalStatement> Parser::parseConditionalStatement() {
     return main_conditional;
 }
 std::shared_ptr<AstForLoopDeclaration> Parser::parseForLoopDeclaration() {
-    std::shared_ptr<AstForLoopDeclaration> forLoop = std::make_shared<AstForLoopDeclaration>(consume(TokenType::For));
+    std::shared_ptr<AstForLoopDeclaration> forLoop = makeNode<AstForLoopDeclaration>(consume(TokenType::For));
     consume(TokenType::LeftParen);
     forLoop->initialization = parseVariableDeclaration();
     consume(TokenType::Semicolon);
@@ -505,15 +650,15 @@ std::shared_ptr<AstForLoopDeclaration> Parser::parseForLoopDeclaration() {
         std::dynamic_pointer_cast<AstBlock>(forLoop->body)->name = "for loop declaration";
 
 
-    forLoop->initializationContext = std::make_shared<AstBlock>();
+    forLoop->initializationContext = makeNode<AstBlock>();
     forLoop->initializationContext->items.push_back(forLoop->initialization);
-    forLoop->initializationContext->items.push_back(std::make_shared<AstExpressionStatement>(forLoop->condition));
-    forLoop->initializationContext->items.push_back(std::make_shared<AstExpressionStatement>(forLoop->increment));
+    forLoop->initializationContext->items.push_back(makeNode<AstExpressionStatement>(forLoop->condition));
+    forLoop->initializationContext->items.push_back(makeNode<AstExpressionStatement>(forLoop->increment));
     forLoop->initializationContext->items.push_back(forLoop->body);
     return forLoop;
 }
 std::shared_ptr<AstForLoopExpression> Parser::parseForLoopExpression() {
-    std::shared_ptr<AstForLoopExpression> forLoop = std::make_shared<AstForLoopExpression>(consume(TokenType::For));
+    std::shared_ptr<AstForLoopExpression> forLoop = makeNode<AstForLoopExpression>(consume(TokenType::For));
     consume(TokenType::LeftParen);
     forLoop->variable = parseOptionalExpression();
     consume(TokenType::Semicolon);
@@ -528,7 +673,7 @@ std::shared_ptr<AstForLoopExpression> Parser::parseForLoopExpression() {
     return forLoop;
 }
 std::shared_ptr<AstWhileLoop> Parser::parseWhileLoop() {
-    std::shared_ptr<AstWhileLoop> whileLoop = std::make_shared<AstWhileLoop>(consume(TokenType::While));
+    std::shared_ptr<AstWhileLoop> whileLoop = makeNode<AstWhileLoop>(consume(TokenType::While));
     consume(TokenType::LeftParen);
     whileLoop->condition = parseExpression();
     consume(TokenType::RightParen);
@@ -536,7 +681,7 @@ std::shared_ptr<AstWhileLoop> Parser::parseWhileLoop() {
     return whileLoop;
 }
 std::shared_ptr<AstDoWhileLoop> Parser::parseDoWhileLoop() {
-    std::shared_ptr<AstDoWhileLoop> doWhileLoop = std::make_shared<AstDoWhileLoop>(consume(TokenType::Do));
+    std::shared_ptr<AstDoWhileLoop> doWhileLoop = makeNode<AstDoWhileLoop>(consume(TokenType::Do));
     doWhileLoop->body = parseStatement();
     consume({TokenType::While, TokenType::LeftParen});
     doWhileLoop->condition = parseExpression();
@@ -546,21 +691,21 @@ std::shared_ptr<AstDoWhileLoop> Parser::parseDoWhileLoop() {
 std::shared_ptr<AstBreak> Parser::parseBreak() {
     Token tok = consume(TokenType::Break);
     consume(TokenType::Semicolon);
-    return std::make_shared<AstBreak>(tok);
+    return makeNode<AstBreak>(tok);
 }
 std::shared_ptr<AstSkip> Parser::parseSkip() {
     Token tok = consume(TokenType::Skip);
     consume(TokenType::Semicolon);
-    return std::make_shared<AstSkip>(tok);
+    return makeNode<AstSkip>(tok);
 }
 
 
-std::shared_ptr<AstExpression> Parser::parseConditionalExpression() {
-    std::shared_ptr<AstExpression> condition = parseLogicalOrExp();
+std::shared_ptr<AstExpression> Parser::parseConditionalExpression(std::shared_ptr<AstExpression> operand) {
+    std::shared_ptr<AstExpression> condition = parseBinaryExp(operand, 1);
     if (!match(TokenType::QuestionMark)) {
         return condition;
     }
-    std::shared_ptr<AstConditionalExpression> conditional = std::make_shared<AstConditionalExpression>();
+    std::shared_ptr<AstConditionalExpression> conditional = makeNode<AstConditionalExpression>();
     conditional->condition = condition;
     conditional->token = consume(TokenType::QuestionMark);
     conditional->trueExpression = parseExpression();
@@ -569,79 +714,21 @@ std::shared_ptr<AstExpression> Parser::parseConditionalExpression() {
     return conditional;
 }
 
-std::shared_ptr<AstExpression> Parser::parseLogicalOrExp() {
-    auto andExp = parseLogicalAndExp();
+std::shared_ptr<AstExpression> Parser::parseBinaryExp(std::shared_ptr<AstExpression> lhs, int minPrecedence) {
+    while (binaryPrecedence(getTokenType()) >= minPrecedence) {
+        Token operatorToken = consume();
+        const int precedence = binaryPrecedence(operatorToken.type);
+        auto rhs = parsePrefixExp();
 
-    while (match(TokenType::DoublePipe)) {
-        Token operatorToken = consume(TokenType::DoublePipe);
-        auto next_andExp = parseLogicalAndExp();
-
-        andExp = std::make_shared<AstBinary>(andExp, toBinaryOperator(operatorToken.type), next_andExp);
-        andExp->token = operatorToken;
-    }
-    return andExp;
-}
-std::shared_ptr<AstExpression> Parser::parseLogicalAndExp() {
-    auto equalityExp = parseEqualityExp();
-
-    while (match(TokenType::DoubleAmpersand)) {
-        Token operatorToken = consume(TokenType::DoubleAmpersand);
-        auto next_equalityExp = parseEqualityExp();
-
-        equalityExp = std::make_shared<AstBinary>(equalityExp, toBinaryOperator(operatorToken.type), next_equalityExp);
-        equalityExp->token = operatorToken;
-    }
-    return equalityExp;
-}
-std::shared_ptr<AstExpression> Parser::parseEqualityExp() {
-    auto relationalExp = parseRelationalExp();
-
-    while (matchAny({TokenType::EqualEqual, TokenType::NotEqual})) {
-        Token operatorToken = consumeAnyOne({TokenType::EqualEqual, TokenType::NotEqual});
-        auto next_relationalExp = parseRelationalExp();
-
-        relationalExp = std::make_shared<AstBinary>(relationalExp, toBinaryOperator(operatorToken.type), next_relationalExp);
-        relationalExp->token = operatorToken;
-    }
-    return relationalExp;
-}
-std::shared_ptr<AstExpression> Parser::parseRelationalExp() {
-    auto additiveExp = parseAdditiveExp();
-
-    while (matchAny({TokenType::GreaterThan, TokenType::GreaterThanEqual, TokenType::LessThan, TokenType::LessThanEqual})) {
-        Token operatorToken = consumeAnyOne(
-            {TokenType::GreaterThan, TokenType::GreaterThanEqual, TokenType::LessThan, TokenType::LessThanEqual}
-        );
-        auto next_additiveExp = parseAdditiveExp();
-
-        additiveExp = std::make_shared<AstBinary>(additiveExp, toBinaryOperator(operatorToken.type), next_additiveExp);
-        additiveExp->token = operatorToken;
-    }
-    return additiveExp;
-}
-std::shared_ptr<AstExpression> Parser::parseAdditiveExp() {
-    auto term = parseMultiplicativeExp();
-
-    while (matchAny({TokenType::Plus, TokenType::Minus})) {
-        Token operatorToken = consumeAnyOne({TokenType::Plus, TokenType::Minus});
-        auto next_term = parseMultiplicativeExp();
-
-        term = std::make_shared<AstBinary>(term, toBinaryOperator(operatorToken.type), next_term);
-        term->token = operatorToken;
-    }
-    return term;
-}
-std::shared_ptr<AstExpression> Parser::parseMultiplicativeExp() {
-    auto factor = parsePrefixExp();
-
-    while (matchAny({TokenType::Star, TokenType::Slash, TokenType::Percent})) {
-        Token operatorToken = consumeAnyOne({TokenType::Star, TokenType::Slash, TokenType::Percent});
-        auto next_factor = parsePrefixExp();
+        // operators that bind more tightly belong to the right hand side
+        while (binaryPrecedence(getTokenType()) > precedence) {
+            rhs = parseBinaryExp(rhs, precedence + 1);
+        }
 
-        factor = std::make_shared<AstBinary>(factor, toBinaryOperator(operatorToken.type), next_factor);
-        factor->token = operatorToken;
+        lhs = makeNode<AstBinary>(lhs, toBinaryOperator(operatorToken.type), rhs);
+        lhs->token = operatorToken;
     }
-    return factor;
+    return lhs;
 }
 std::shared_ptr<AstExpression> Parser::parsePrefixExp() {
 
@@ -658,17 +745,17 @@ std::shared_ptr<AstExpression> Parser::parsePrefixExp() {
             case TokenType::Bang:
             case TokenType::Minus:
             case TokenType::Tilde: {
-                exp = std::make_shared<AstUnary>(toUnaryOperator(it->type), exp);
+                exp = makeNode<AstUnary>(toUnaryOperator(it->type), exp);
                 exp->token = *it;
                 break;
             }
             case TokenType::DollarSign: {
-                exp = std::make_shared<AstAddressOf>(exp);
+                exp = makeNode<AstAddressOf>(exp);
                 exp->token = *it;
                 break;
             }
             case TokenType::Star: {
-                exp = std::make_shared<AstDereference>(exp);
+                exp = makeNode<AstDereference>(exp);
                 exp->token = *it;
                 break;
             }
@@ -688,7 +775,7 @@ std::shared_ptr<AstExpression> Parser::parsePostfixExp() {
 
     while (match(TokenType::LeftBracket)) {
         Token operatorToken = consume(TokenType::LeftBracket);
-        auto next_exp = std::make_shared<AstArrayAccess>();
+        auto next_exp = makeNode<AstArrayAccess>();
         next_exp->token = operatorToken;
         next_exp->array = exp;
         next_exp->index = parseExpression();
@@ -721,7 +808,7 @@ std::shared_ptr<AstExpression> Parser::parsePrimaryExp() {
         return parseStringLiteral();
     }
     else if (match(TokenType::Identifier)) {
-        auto varAccess = std::make_shared<AstVariableAccess>();
+        auto varAccess = makeNode<AstVariableAccess>();
         varAccess->token = consume(TokenType::Identifier);
         varAccess->name = varAccess->token.value;
         return varAccess;
@@ -734,34 +821,29 @@ std::shared_ptr<AstExpression> Parser::parsePrimaryExp() {
 
 
 std::shared_ptr<AstExpression> Parser::parseNumber() {
-    std::shared_ptr<AstInteger> number = std::make_shared<AstInteger>(consume(TokenType::Number));
+    std::shared_ptr<AstInteger> number = makeNode<AstInteger>(consume(TokenType::Number));
     try {
-        number->value = std::stoll(number->token.value);
+        number->value = std::stoll(std::string(number->token.value));
     }
     catch (std::out_of_range) {
         hasError = true;
-        auto error = std::make_shared<AstErrorExpression>(stringify(
+        auto error = makeNode<AstErrorExpression>(stringify(
             filename,
             ":",
-            getCurrentToken().position.line,
+            getCurrentToken().getLine(),
             ":",
-            getCurrentToken().position.column,
+            getCurrentToken().getColumn(),
             ":\tNumber doesn't fit into 64 bits."
         ));
-        error->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
+        error->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::ErrorType);
         error->token = number->token;
         return error;
     }
-    number->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::I64);
+    number->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::I64);
     return number;
 }
-std::shared_ptr<AstAssignLocation> Parser::parseAssignmentLocation() {
-    std::shared_ptr<AstAssignLocation> location = std::make_shared<AstAssignLocation>();
-    location->expr = parsePrefixExp();
-
-    bool valid = false;
-
-    switch (location->expr->getType()) {
+std::shared_ptr<AstAssignment> Parser::parseAssignment(std::shared_ptr<AstExpression> lvalue) {
+    switch (lvalue->getType()) {
         case AstNodeType::AstVariableAccess:
         case AstNodeType::AstArrayAccess:
         case AstNodeType::AstDereference:    {
@@ -772,18 +854,16 @@ std::shared_ptr<AstAssignLocation> Parser::parseAssignmentLocation() {
             parserError("Expected array access, dereference or variable, but got ", getCurrentToken().toString());
             break;
     }
-    return location;
-}
 
-std::shared_ptr<AstAssignment> Parser::parseAssignment() {
-    std::shared_ptr<AstAssignment> assignment = std::make_shared<AstAssignment>();
-    assignment->lvalue = parseAssignmentLocation();
+    std::shared_ptr<AstAssignment> assignment = makeNode<AstAssignment>();
+    assignment->lvalue = makeNode<AstAssignLocation>();
+    assignment->lvalue->expr = lvalue;
     assignment->token = consume(TokenType::Assign);
     assignment->rvalue = parseExpression();
     return assignment;
 }
 std::shared_ptr<AstFunctionCall> Parser::parseFunctionCall() {
-    std::shared_ptr<AstFunctionCall> functionCall = std::make_shared<AstFunctionCall>(consume(TokenType::ID));
+    std::shared_ptr<AstFunctionCall> functionCall = makeNode<AstFunctionCall>(consume(TokenType::ID));
     functionCall->name = functionCall->token.value;
     consume(TokenType::LeftParen);
     while (!match(TokenType::RightParen)) {
@@ -801,7 +881,7 @@ std::shared_ptr<AstFunctionCall> Parser::parseFunctionCall() {
 std::shared_ptr<AstInteger> Parser::parseCharacterLiteral() {
     auto tok = consume(TokenType::CharacterLiteral);
 
-    auto character = std::make_shared<AstInteger>();
+    auto character = makeNode<AstInteger>();
     character->token = tok;
     if (tok.value.size() == 3) {
         character->value = tok.value.at(1);
@@ -822,14 +902,14 @@ std::shared_ptr<AstInteger> Parser::parseCharacterLiteral() {
         parserError("Character literal is too big or empty: ", tok.toString());
         return nullptr;
     }
-    character->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::I8);
+    character->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::I8);
     return character;
 }
 
 std::shared_ptr<AstArrayLiteral> Parser::parseStringLiteral() {
     auto tok = consume(TokenType::StringLiteral);
 
-    auto string = std::make_shared<AstArrayLiteral>();
+    auto string = makeNode<AstArrayLiteral>();
     string->token = tok;
 
     // remove the quotes
@@ -853,35 +933,33 @@ std::shared_ptr<AstArrayLiteral> Parser::parseStringLiteral() {
                 default:   parserError("String contains invalid escape code: ", tok.toString()); return nullptr;
             }
         }
-        string->elements.push_back(std::make_shared<AstInteger>(c));
-        string->elements.back()->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::I8);
+        string->elements.push_back(makeNode<AstInteger>(c));
+        string->elements.back()->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::I8);
 
         // construct a pseudo token
         Token& element_token = string->elements.back()->token;
         element_token = tok;
         element_token.type = TokenType::CharacterLiteral;
-        element_token.position.column += i + 1;
         element_token.position.startPos += i + 1;
         element_token.position.endPos = element_token.position.startPos;
     }
     // insert a null termination
-    string->elements.push_back(std::make_shared<AstInteger>('\0'));
-    string->elements.back()->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::I8);
+    string->elements.push_back(makeNode<AstInteger>('\0'));
+    string->elements.back()->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::I8);
     Token& element_token = string->elements.back()->token;
     element_token = tok;
     element_token.type = TokenType::CharacterLiteral;
-    element_token.position.column += tok.value.length() + 1;
     element_token.position.startPos += tok.value.length() + 1;
     element_token.position.endPos = element_token.position.startPos;
 
-    auto type = std::make_shared<AstArrayType>();
-    type->subtype = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::I8);
-    type->size = std::make_shared<AstInteger>(string->elements.size());
+    auto type = makeNode<AstArrayType>();
+    type->subtype = makeNode<AstPrimitiveType>(RSharpPrimitiveType::I8);
+    type->size = makeNode<AstInteger>(string->elements.size());
     return string;
 }
 
 std::shared_ptr<AstArrayLiteral> Parser::parseArrayLiteral() {
-    auto array = std::make_shared<AstArrayLiteral>(consume(TokenType::LeftBracket));
+    auto array = makeNode<AstArrayLiteral>(consume(TokenType::LeftBracket));
     while (!match(TokenType::RightBracket)) {
         array->elements.push_back(parseExpression());
         if (!match(TokenType::Comma)) {
@@ -898,7 +976,7 @@ std::shared_ptr<AstArrayLiteral> Parser::parseArrayLiteral() {
 
 
 std::shared_ptr<AstVariableDeclaration> Parser::parseVariableDeclaration() {
-    std::shared_ptr<AstVariableDeclaration> variable = std::make_shared<AstVariableDeclaration>(consume(TokenType::Identifier));
+    std::shared_ptr<AstVariableDeclaration> variable = makeNode<AstVariableDeclaration>(consume(TokenType::Identifier));
     variable->name = variable->token.value;
     consume(TokenType::Colon);
     variable->semanticType = parseType();
@@ -906,7 +984,7 @@ std::shared_ptr<AstVariableDeclaration> Parser::parseVariableDeclaration() {
         consume(TokenType::Assign);
         variable->value = parseExpression();
     }
-    variable->variable = std::make_shared<SemanticVariableData>();
+    variable->variable = makeNode<SemanticVariableData>();
     variable->variable->name = variable->name;
     variable->variable->type = variable->semanticType;
     return variable;
@@ -914,7 +992,7 @@ std::shared_ptr<AstVariableDeclaration> Parser::parseVariableDeclaration() {
 
 std::shared_ptr<AstArrayType> Parser::parseArrayType() {
     auto leftBracket = consume(TokenType::LeftBracket);
-    auto array = std::make_shared<AstArrayType>(parseType());
+    auto array = makeNode<AstArrayType>(parseType());
     array->token = leftBracket;
     if (match(TokenType::Comma)) {
         consume(TokenType::Comma);
@@ -927,17 +1005,17 @@ std::shared_ptr<AstArrayType> Parser::parseArrayType() {
 std::shared_ptr<AstType> Parser::parseType() {
     if (match(TokenType::Typename)) {
         auto typename_tok = consume(TokenType::Typename);
-        auto type = stringToType(typename_tok.value);
+        auto type = stringToType(std::string(typename_tok.value));
         if (type == RSharpPrimitiveType::NONE) {
             parserError("Unknown type ", getCurrentToken().toString());
         }
-        auto type_ast = std::make_shared<AstPrimitiveType>(type);
+        auto type_ast = makeNode<AstPrimitiveType>(type);
         type_ast->token = typename_tok;
         return type_ast;
     }
     else if (match(TokenType::Star)) {
         auto star = consume(TokenType::Star);
-        auto pointer = std::make_shared<AstPointerType>(parseType());
+        auto pointer = makeNode<AstPointerType>(parseType());
         pointer->token = star;
         return pointer;
     }
@@ -951,7 +1029,7 @@ std::shared_ptr<AstType> Parser::parseType() {
 }
 
 std::shared_ptr<AstTags> Parser::parseTags() {
-    auto tags = std::make_shared<AstTags>();
+    auto tags = makeNode<AstTags>();
     if (match(TokenType::LeftBracket)) {
         consume(TokenType::LeftBracket);
         do {
@@ -969,7 +1047,7 @@ std::shared_ptr<AstTags> Parser::parseTags() {
     return tags;
 }
 std::shared_ptr<AstParameterList> Parser::parseParameterList() {
-    std::shared_ptr<AstParameterList> parameterList = std::make_shared<AstParameterList>();
+    std::shared_ptr<AstParameterList> parameterList = makeNode<AstParameterList>();
     consume(TokenType::LeftParen);
     while (!match(TokenType::RightParen)) {
         parameterList->parameters.push_back(parseVariableDeclaration());
@@ -982,14 +1060,18 @@ std::shared_ptr<AstParameterList> Parser::parseParameterList() {
 }
 
 // helpers
+std::shared_ptr<AstStatement> Parser::parseForLoop() {
+    // "for (name: ..." declares the loop variable, everything else is an expression
+    if (match(2, {TokenType::Identifier, TokenType::Colon})) {
+        return parseForLoopDeclaration();
+    }
+    return parseForLoopExpression();
+}
 std::shared_ptr<AstExpression> Parser::parseOptionalExpression() {
-    try {
-        auto ckpt = getTokenCheckpoint();
+    if (isExpressionStart()) {
         return parseExpression();
     }
-    catch (ParsingError& e) {
-        auto exp = std::make_shared<AstEmptyExpression>();
-        exp->semanticType = std::make_shared<AstPrimitiveType>(RSharpPrimitiveType::C_void);
-        return exp;
-    }
+    auto exp = makeNode<AstEmptyExpression>();
+    exp->semanticType = makeNode<AstPrimitiveType>(RSharpPrimitiveType::C_void);
+    return exp;
 }
@@ -1,65 +1,69 @@
 #include "R-Sharp/frontend/ParsingCache.hpp"
 
-#include <stdexcept>
-#include <algorithm>
-#include <filesystem>
+#include <utility>
 
-bool ParsingCache::contains(std::string const& filename, std::string const& identifier) {
-    std::string absolute_filename = std::filesystem::absolute(filename);
+#include <sys/stat.h>
 
+ParsingCache::File& ParsingCache::getFile(std::string const& filename) {
+    auto path = pathsToFileIds.find(filename);
+    if (path == pathsToFileIds.end()) {
+        struct stat info;
+        FileId id;
+        if (stat(filename.c_str(), &info) == 0) {
+            id = FileId{.device = info.st_dev, .inode = info.st_ino};
+        }
+        else {
+            // no real file is on device -1
+            id = FileId{.device = static_cast<dev_t>(-1), .inode = nextMissingFileId++};
+        }
+        path = pathsToFileIds.emplace(filename, id).first;
+    }
+    return files[path->second];
+}
 
-    return containsWildcard(absolute_filename) || containsNonWildcard(absolute_filename, identifier);
+bool ParsingCache::contains(std::string const& filename, std::string const& identifier) {
+    std::lock_guard lock(mutex);
+    auto const& file = getFile(filename);
+    return file.isWildcardIncluded || file.importedIdentifiers.count(identifier);
 }
 bool ParsingCache::containsWildcard(std::string const& filename) {
-    std::string absolute_filename = std::filesystem::absolute(filename);
-
-    // handle paths that are not identical but equivalent
-    auto equivalentFind = std::find_if(
-        filenamesToAlreadyImportedIdentifiers.begin(),
-        filenamesToAlreadyImportedIdentifiers.end(),
-        [&](auto const& other) {
-            return std::filesystem::equivalent(std::filesystem::path(filename), std::filesystem::path(other.first));
-        }
-    );
-
-    return wildcardIncludedFiles.count(absolute_filename);
+    std::lock_guard lock(mutex);
+    return getFile(filename).isWildcardIncluded;
 }
 bool ParsingCache::containsNonWildcard(std::string const& filename, std::string const& identifier) {
-    std::string absolute_filename = std::filesystem::absolute(filename);
-    try {
-        auto const& ids = filenamesToAlreadyImportedIdentifiers.at(absolute_filename);
-        return std::find(ids.begin(), ids.end(), identifier) != ids.end();
-    }
-    catch (std::out_of_range) {
-        // handle paths that are not identical but equivalent
-        auto equivalentFind = std::find_if(
-            filenamesToAlreadyImportedIdentifiers.begin(),
-            filenamesToAlreadyImportedIdentifiers.end(),
-            [&](auto const& other) {
-                return std::filesystem::equivalent(
-                    std::filesystem::path(filename),
-                    std::filesystem::path(other.first)
-                );
-            }
-        );
-        if (equivalentFind != filenamesToAlreadyImportedIdentifiers.end()) {
-            return containsNonWildcard((*equivalentFind).first, identifier);
-        }
-
-        return false;
-    }
+    std::lock_guard lock(mutex);
+    return getFile(filename).importedIdentifiers.count(identifier);
 }
 void ParsingCache::add(std::string const& filename, std::string const& identifier) {
-    std::string absolute_filename = std::filesystem::absolute(filename);
-    try {
-        auto& ids = filenamesToAlreadyImportedIdentifiers.at(absolute_filename);
-        ids.push_back(identifier);
-    }
-    catch (std::out_of_range) {
-        filenamesToAlreadyImportedIdentifiers.insert({absolute_filename, std::vector{identifier}});
-    }
+    std::lock_guard lock(mutex);
+    getFile(filename).importedIdentifiers.insert(identifier);
 }
 void ParsingCache::addWildcard(std::string const& filename) {
-    std::string absolute_filename = std::filesystem::absolute(filename);
-    wildcardIncludedFiles.insert(absolute_filename);
+    std::lock_guard lock(mutex);
+    getFile(filename).isWildcardIncluded = true;
+}
+
+ParsingCache::Module* ParsingCache::getModule(std::string const& filename) {
+    std::lock_guard lock(mutex);
+    auto& file = getFile(filename);
+    return file.module ? &*file.module : nullptr;
+}
+ParsingCache::Module& ParsingCache::addModule(std::string const& filename) {
+    std::lock_guard lock(mutex);
+    auto& file = getFile(filename);
+    if (!file.module) file.module.emplace();
+    return *file.module;
+}
+
+bool ParsingCache::reservePreload(std::string const& filename) {
+    std::lock_guard lock(mutex);
+    return !std::exchange(getFile(filename).isPreloading, true);
+}
+void ParsingCache::addParsedFile(std::string const& filename, ParsedFile file) {
+    std::lock_guard lock(mutex);
+    getFile(filename).parsedFile = std::move(file);
+}
+std::optional<ParsingCache::ParsedFile> ParsingCache::takeParsedFile(std::string const& filename) {
+    std::lock_guard lock(mutex);
+    return std::exchange(getFile(filename).parsedFile, std::nullopt);
 }
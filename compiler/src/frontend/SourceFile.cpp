@@ -0,0 +1,97 @@
+#include "R-Sharp/frontend/SourceFile.hpp"
+#include "R-Sharp/Logging.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SourceFile const& SourceFile::load(std::string const& filename) {
+    static std::mutex mutex;
+    static std::vector<std::unique_ptr<SourceFile>> loadedFiles;
+
+    auto file = std::unique_ptr<SourceFile>(new SourceFile(filename));
+
+    std::lock_guard lock(mutex);
+    loadedFiles.push_back(std::move(file));
+    return *loadedFiles.back();
+}
+
+SourceFile::SourceFile(std::string const& filename): filename(filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        Fatal("Could not open file: \"", filename, "\"");
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            content = std::string_view(static_cast<char const*>(data), info.st_size);
+            isMapped = true;
+        }
+    }
+    close(fd);
+
+    // empty files can't be mapped, pipes and the like have no size
+    if (!isMapped) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            Fatal("Could not open file: \"", filename, "\"");
+        }
+        std::stringstream ss;
+        ss << file.rdbuf();
+        readContent = ss.str();
+        content = readContent;
+    }
+}
+
+SourceFile::~SourceFile() {
+    if (isMapped) munmap(const_cast<char*>(content.data()), content.size());
+}
+
+std::vector<size_t> const& SourceFile::getLineStarts() const {
+    std::call_once(lineStartsFlag, [this]() {
+        lineStarts.push_back(0);
+        // memchr skips over the text many bytes at a time
+        auto begin = content.data();
+        auto end = begin + content.size();
+        for (auto c = begin; (c = static_cast<char const*>(std::memchr(c, '\n', end - c))); c++) {
+            lineStarts.push_back(c - begin + 1);
+        }
+    });
+    return lineStarts;
+}
+
+SourceLocation SourceFile::getLocation(size_t offset) const {
+    auto const& starts = getLineStarts();
+    // the last line starting at or before the offset
+    auto line = std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin();
+    return SourceLocation{
+        .line = int(line),
+        .column = int(offset - starts[line - 1] + 1),
+    };
+}
+
+size_t SourceFile::getLineStart(int line) const {
+    auto const& starts = getLineStarts();
+    if (line < 1) return 0;
+    if (static_cast<size_t>(line) > starts.size()) return content.size();
+    return starts[line - 1];
+}
+
+std::string_view SourceFile::getLine(int line) const {
+    auto start = getLineStart(line);
+    auto end = getLineStart(line + 1);
+    auto text = content.substr(start, end - start);
+    if (!text.empty() && text.back() == '\n') text.remove_suffix(1);
+    return text;
+}
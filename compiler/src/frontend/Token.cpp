@@ -1,11 +1,21 @@
 #include "R-Sharp/frontend/Token.hpp"
 #include "R-Sharp/frontend/Utils.hpp"
+#include "R-Sharp/frontend/SourceFile.hpp"
 #include "R-Sharp/Logging.hpp"
 
 std::string Token::toString() const {
     return "Token(" + tokenTypeToString(type) + ", \"" + escapeString(value) + "\")";
 }
 
+int Token::getLine() const {
+    if (!source) return 0;
+    return source->getLocation(position.startPos).line;
+}
+int Token::getColumn() const {
+    if (!source) return 0;
+    return source->getLocation(position.startPos).column;
+}
+
 std::string tokenTypeToString(TokenType type) {
     switch (type) {
         case TokenType::None:             return "None";
@@ -1,78 +1,112 @@
 #include "R-Sharp/frontend/Tokenizer.hpp"
-
-#include <fstream>
-#include <sstream>
-
-std::string characterRange(char start, char end) {
-    if (end < start) {
-        std::swap(start, end);
+#include "R-Sharp/frontend/CharacterScanning.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace {
+
+enum class CharacterClass : uint8_t {
+    Invalid,
+    Whitespace,
+    IdentifierBegin,
+    Digit,
+    Slash,
+    SingleQuote,
+    DoubleQuote,
+    Punctuation,
+};
+
+constexpr std::array<CharacterClass, 256> characterClasses = []() {
+    std::array<CharacterClass, 256> classes{};
+    for (int c = 0; c < 256; c++) {
+        if (isWhitespace(c)) classes[c] = CharacterClass::Whitespace;
+        else if (isIdentifierBegin(c)) classes[c] = CharacterClass::IdentifierBegin;
+        else if (isDigit(c)) classes[c] = CharacterClass::Digit;
     }
-    std::string str;
-    for (char c = start; c <= end; c++) {
-        str += c;
-    }
-    return str;
+    for (char c : std::string_view("@:;,()[]{}!~?+-*%&|=<>$"))
+        classes[static_cast<uint8_t>(c)] = CharacterClass::Punctuation;
+    classes['/'] = CharacterClass::Slash;
+    classes['\''] = CharacterClass::SingleQuote;
+    classes['"'] = CharacterClass::DoubleQuote;
+    return classes;
+}();
+
+struct Keyword {
+    std::string_view text;
+    TokenType type;
+};
+
+/*
+A perfect hash over all keywords, no two of them share a slot. Building
+keywordTable fails to compile if they do.
+Identifiers shorter than two characters are never keywords.
+*/
+constexpr size_t keywordHash(std::string_view word) {
+    return (word[0] + word[1] + 6 * (word.back() + word.size())) % 32;
 }
 
+constexpr std::array<Keyword, 32> keywordTable = []() {
+    constexpr Keyword keywords[] = {
+        {"if",     TokenType::If      },
+        {"elif",   TokenType::Elif    },
+        {"else",   TokenType::Else    },
+        {"return", TokenType::Return  },
+        {"while",  TokenType::While   },
+        {"for",    TokenType::For     },
+        {"do",     TokenType::Do      },
+        {"break",  TokenType::Break   },
+        {"skip",   TokenType::Skip    },
+        {"i8",     TokenType::Typename},
+        {"i16",    TokenType::Typename},
+        {"i32",    TokenType::Typename},
+        {"i64",    TokenType::Typename},
+        {"c_void", TokenType::Typename},
+    };
+    std::array<Keyword, 32> table{};
+    for (auto keyword : keywords) {
+        auto& slot = table[keywordHash(keyword.text)];
+        // not a constant expression, so a collision fails to compile
+        if (!slot.text.empty()) throw "two keywords share a slot, keywordHash needs to be changed";
+        slot = keyword;
+    }
+    return table;
+}();
+
+TokenType identifierType(std::string_view word) {
+    if (word.size() < 2) return TokenType::Identifier;
+    auto const& keyword = keywordTable[keywordHash(word)];
+    return keyword.text == word ? keyword.type : TokenType::Identifier;
+}
 
-static const std::string numbers = characterRange('0', '9');
-static const std::string validIdentifierBegin = characterRange('a', 'z') + characterRange('A', 'Z') + "_";
-static const std::string validIdentifierChars = validIdentifierBegin + characterRange('0', '9');
+}
 
 
 Tokenizer::Tokenizer(std::string const& filename)
-    : currentPosition(0), line(1), column(1), filename(filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        Fatal("Could not open file: \"", filename, "\"");
-    }
-    std::stringstream ss;
-    ss << file.rdbuf();
-    source = ss.str();
-    source_ptr = std::make_shared<std::string>(source);
+    : sourceFile(SourceFile::load(filename)), currentPosition(0), filename(filename) {
+    source = sourceFile.getContent();
 }
 
-bool Tokenizer::match(std::string str) const {
+Token Tokenizer::makeToken(TokenType type, size_t startPos) const {
+    return Token(
+        type,
+        source.substr(startPos, currentPosition - startPos),
+        TokenLocation{startPos, currentPosition},
+        &sourceFile
+    );
+}
+
+bool Tokenizer::match(std::string_view str) const {
     return !isAtEnd() && source.substr(currentPosition, str.size()) == str;
 }
 bool Tokenizer::match(char c) const {
     return !isAtEnd() && getCurrentChar() == c;
 }
-bool Tokenizer::matchAny(std::string str) const {
-    for (char c : str) {
-        if (match(c)) {
-            return true;
-        }
-    }
-    return false;
-}
 
-bool Tokenizer::match(int offset, std::string str) const {
-    return !isAtEnd(offset) && source.substr(currentPosition + offset, str.size()) == str;
-}
-bool Tokenizer::match(int offset, char c) const {
-    return !isAtEnd(offset) && getChar(offset) == c;
-}
-bool Tokenizer::matchAny(int offset, std::string str) const {
-    for (char c : str) {
-        if (match(offset, c)) {
-            return true;
-        }
-    }
-    return false;
-}
 
 char Tokenizer::consume() {
-    char c = getCurrentChar();
-    if (getCurrentChar() == '\n') {
-        line++;
-        column = 1;
-    }
-    else {
-        column++;
-    }
-    currentPosition++;
-    return c;
+    if (isAtEnd()) return '\0';
+    return source[currentPosition++];
 }
 char Tokenizer::consume(char c) {
     if (match(c)) {
@@ -80,43 +114,15 @@ char Tokenizer::consume(char c) {
     }
     return '\0';
 }
-std::string Tokenizer::consume(std::string str) {
+bool Tokenizer::consume(std::string_view str) {
     if (!match(str)) {
         logError("Expected: \"", str, "\"");
-        return "\0";
-    }
-    std::string result;
-    for (int i = 0; i < str.size(); i++) {
-        result += consume();
-    }
-    return result;
-}
-char Tokenizer::consumeAnyOne(std::string str) {
-    for (char c : str) {
-        if (match(c)) {
-            return c;
-        }
-    }
-    logError("Expected: \"", str, "\"");
-    return '\0';
-}
-std::string Tokenizer::consumeAny(std::string str) {
-    std::string result;
-    while (matchAny(str)) {
-        result += consume();
-    }
-    return result;
-}
-std::string Tokenizer::consumeUntil(std::string str) {
-    std::string result;
-    while (!match(str)) {
-        result += consume();
+        return false;
     }
-    // consume the delimiter
     for (int i = 0; i < str.size(); i++) {
         consume();
     }
-    return result;
+    return true;
 }
 
 bool Tokenizer::isAtEnd(int offset) const {
@@ -131,189 +137,147 @@ char Tokenizer::getChar(int offset) const {
     return source[currentPosition + offset];
 }
 
-#define SIMPLE_TOKEN(characters, type)                                                                \
-    if (match(characters)) {                                                                          \
-        int line_ = line;                                                                             \
-        int column_ = column;                                                                         \
-        size_t pos_ = currentPosition;                                                                \
-        auto chars = consume(characters);                                                             \
-        token = Token(type, chars, TokenLocation{pos_, currentPosition, line_, column_}, source_ptr); \
-    }
-#define KEYWORD_TOKEN(characters, type)                                                               \
-    if (match(characters) && !matchAny(std::string(characters).size(), validIdentifierChars)) {       \
-        int line_ = line;                                                                             \
-        int column_ = column;                                                                         \
-        size_t pos_ = currentPosition;                                                                \
-        auto chars = consume(characters);                                                             \
-        token = Token(type, chars, TokenLocation{pos_, currentPosition, line_, column_}, source_ptr); \
-    }
-
-#define ENCLOSING_TOKEN(startChars, endChars, type)                                                   \
-    if (match(startChars)) {                                                                          \
-        int line_ = line;                                                                             \
-        int column_ = column;                                                                         \
-        size_t pos_ = currentPosition;                                                                \
-        std::string chars = consume(startChars);                                                      \
-        chars += consumeUntil(endChars) + endChars;                                                   \
-        token = Token(type, chars, TokenLocation{pos_, currentPosition, line_, column_}, source_ptr); \
-    }
-#define SET_TOKEN(characters, type)                                                                   \
-    if (matchAny(characters)) {                                                                       \
-        int line_ = line;                                                                             \
-        int column_ = column;                                                                         \
-        size_t pos_ = currentPosition;                                                                \
-        auto chars = consumeAny(characters);                                                          \
-        token = Token(type, chars, TokenLocation{pos_, currentPosition, line_, column_}, source_ptr); \
-    }
-#define COMPLEX_SET_TOKEN(beginCharacters, characters, type)                                          \
-    if (matchAny(beginCharacters)) {                                                                  \
-        int line_ = line;                                                                             \
-        int column_ = column;                                                                         \
-        size_t pos_ = currentPosition;                                                                \
-        auto chars = consumeAny(characters);                                                          \
-        token = Token(type, chars, TokenLocation{pos_, currentPosition, line_, column_}, source_ptr); \
-    }
+void Tokenizer::advance(size_t count) {
+    currentPosition += count;
+}
 
 Token Tokenizer::nextToken() {
     while (!isAtEnd()) {
-        Token token;
-        token.type = TokenType::None;
-
-        // clang-format off
-        ENCLOSING_TOKEN("//", "\n", TokenType::Comment)
-        else ENCLOSING_TOKEN("/*", "*/", TokenType::Comment)
-        else if (match('\'')) {
-            // clang-format on
-
-            int line_ = line;
-            int column_ = column;
-            size_t pos_ = currentPosition;
-            std::string chars = consume("\'");
-            while (!match('\'')) {
-                if (isAtEnd()) {
-                    logError("Unexpected end of file while tokenizing character literal.\n");
-                    break;
+        const size_t start = currentPosition;
+        const auto rest = source.substr(currentPosition);
+        const char c = rest[0];
+
+        switch (characterClasses[static_cast<uint8_t>(c)]) {
+            case CharacterClass::Whitespace: advance(spanWhitespace(rest)); continue;
+
+            case CharacterClass::IdentifierBegin: {
+                advance(spanIdentifierCharacters(rest));
+                auto type = identifierType(source.substr(start, currentPosition - start));
+                return makeToken(type, start);
+            }
+            case CharacterClass::Digit:
+                advance(spanDigits(rest));
+                return makeToken(TokenType::Number, start);
+
+            case CharacterClass::Slash:
+                if (getChar(1) == '/') {
+                    // the comment includes the newline
+                    auto end = rest.find('\n');
+                    advance(end == std::string_view::npos ? rest.size() : end + 1);
+                    return makeToken(TokenType::Comment, start);
                 }
-                char c = consume();
-                chars += c;
-                if (c == '\\') {
-                    chars += consume();
+                if (getChar(1) == '*') {
+                    auto end = rest.find("*/", 2);
+                    advance(end == std::string_view::npos ? rest.size() : end + 2);
+                    return makeToken(TokenType::Comment, start);
                 }
-            }
-            chars += consume("\'");
-            token = Token(TokenType::CharacterLiteral, chars, TokenLocation{pos_, currentPosition, line_, column_}, source_ptr);
-        }
-        else if (match('"')) {
-            int line_ = line;
-            int column_ = column;
-            size_t pos_ = currentPosition;
-            std::string chars = consume("\"");
-            while (!match('"')) {
-                if (isAtEnd()) {
-                    logError("Unexpected end of file while tokenizing string literal.\n");
-                    break;
+                advance(1);
+                return makeToken(TokenType::Slash, start);
+
+            case CharacterClass::SingleQuote:
+                consume();
+                while (!match('\'')) {
+                    if (isAtEnd()) {
+                        logError("Unexpected end of file while tokenizing character literal.\n");
+                        break;
+                    }
+                    if (consume() == '\\') {
+                        consume();
+                    }
                 }
-                char c = consume();
-                chars += c;
-                if (c == '\\') {
-                    chars += consume();
+                consume("\'");
+                return makeToken(TokenType::CharacterLiteral, start);
+
+            case CharacterClass::DoubleQuote:
+                consume();
+                while (!match('"')) {
+                    if (isAtEnd()) {
+                        logError("Unexpected end of file while tokenizing string literal.\n");
+                        break;
+                    }
+                    if (consume() == '\\') {
+                        consume();
+                    }
+                }
+                consume("\"");
+                return makeToken(TokenType::StringLiteral, start);
+
+            case CharacterClass::Punctuation: {
+                const char next = getChar(1);
+                // the token type if `c` is followed by `second`, and if it stands alone
+                const auto pair = [&](char second, TokenType both, TokenType single) {
+                    advance(next == second ? 2 : 1);
+                    return makeToken(next == second ? both : single, start);
+                };
+
+                switch (c) {
+                    case ':': return pair(':', TokenType::DoubleColon, TokenType::Colon);
+                    case '=': return pair('=', TokenType::EqualEqual, TokenType::Assign);
+                    case '!': return pair('=', TokenType::NotEqual, TokenType::Bang);
+                    case '<': return pair('=', TokenType::LessThanEqual, TokenType::LessThan);
+                    case '>': return pair('=', TokenType::GreaterThanEqual, TokenType::GreaterThan);
+                    // single '&' and '|' are not part of the language
+                    case '&': if (next == '&') return pair('&', TokenType::DoubleAmpersand, TokenType::None); break;
+                    case '|': if (next == '|') return pair('|', TokenType::DoublePipe, TokenType::None); break;
+                    default:  break;
                 }
-            }
-            chars += consume("\"");
-            token = Token(TokenType::StringLiteral, chars, TokenLocation{pos_, currentPosition, line_, column_}, source_ptr);
-        }
 
-        else KEYWORD_TOKEN("if", TokenType::If)
-        else KEYWORD_TOKEN("elif", TokenType::Elif)
-        else KEYWORD_TOKEN("else", TokenType::Else)
-
-        else KEYWORD_TOKEN("return", TokenType::Return)
-
-        else KEYWORD_TOKEN("while", TokenType::While)
-        else KEYWORD_TOKEN("for", TokenType::For)
-        else KEYWORD_TOKEN("do", TokenType::Do)
-        else KEYWORD_TOKEN("break", TokenType::Break)
-        else KEYWORD_TOKEN("skip", TokenType::Skip)
-
-        else KEYWORD_TOKEN("i8", TokenType::Typename)
-        else KEYWORD_TOKEN("i16", TokenType::Typename)
-        else KEYWORD_TOKEN("i32", TokenType::Typename)
-        else KEYWORD_TOKEN("i64", TokenType::Typename)
-        else KEYWORD_TOKEN("c_void", TokenType::Typename)
-
-        else SIMPLE_TOKEN('@', TokenType::At)
-        else SIMPLE_TOKEN("::", TokenType::DoubleColon)
-
-        else SIMPLE_TOKEN(';', TokenType::Semicolon)
-        else SIMPLE_TOKEN(',', TokenType::Comma)
-        else SIMPLE_TOKEN(':', TokenType::Colon)
-
-        else SIMPLE_TOKEN('(', TokenType::LeftParen)
-        else SIMPLE_TOKEN(')', TokenType::RightParen)
-        else SIMPLE_TOKEN('[', TokenType::LeftBracket)
-        else SIMPLE_TOKEN(']', TokenType::RightBracket)
-        else SIMPLE_TOKEN('{', TokenType::LeftBrace)
-        else SIMPLE_TOKEN('}', TokenType::RightBrace)
-        
-        else SIMPLE_TOKEN("&&", TokenType::DoubleAmpersand)
-        else SIMPLE_TOKEN("||", TokenType::DoublePipe)
-        else SIMPLE_TOKEN("==", TokenType::EqualEqual)
-        else SIMPLE_TOKEN("!=", TokenType::NotEqual)
-        else SIMPLE_TOKEN("<=", TokenType::LessThanEqual)
-        else SIMPLE_TOKEN(">=", TokenType::GreaterThanEqual)
-        else SIMPLE_TOKEN("<", TokenType::LessThan)
-        else SIMPLE_TOKEN(">", TokenType::GreaterThan)
-
-        else SIMPLE_TOKEN('!', TokenType::Bang)
-        else SIMPLE_TOKEN('~', TokenType::Tilde)
-        else SIMPLE_TOKEN('?', TokenType::QuestionMark)
-
-        else SIMPLE_TOKEN('+', TokenType::Plus)
-        else SIMPLE_TOKEN('-', TokenType::Minus)
-        else SIMPLE_TOKEN('*', TokenType::Star)
-        else SIMPLE_TOKEN('/', TokenType::Slash)
-        else SIMPLE_TOKEN('%', TokenType::Percent)
-
-        else SIMPLE_TOKEN('=', TokenType::Assign)
-        else SIMPLE_TOKEN('$', TokenType::DollarSign)
-
-        
-
-        else COMPLEX_SET_TOKEN(validIdentifierBegin, validIdentifierChars, TokenType::Identifier)
-        else SET_TOKEN(numbers, TokenType::Number)
-        else if (std::isspace(getCurrentChar())) 
-            consume();
-
-        else {
-            logError("Unexpected character '", consume(), "'");
-        }
+                static constexpr std::array<TokenType, 256> singleCharacterTokens = []() {
+                    std::array<TokenType, 256> types{};
+                    types['@'] = TokenType::At;
+                    types[';'] = TokenType::Semicolon;
+                    types[','] = TokenType::Comma;
+                    types['('] = TokenType::LeftParen;
+                    types[')'] = TokenType::RightParen;
+                    types['['] = TokenType::LeftBracket;
+                    types[']'] = TokenType::RightBracket;
+                    types['{'] = TokenType::LeftBrace;
+                    types['}'] = TokenType::RightBrace;
+                    types['~'] = TokenType::Tilde;
+                    types['?'] = TokenType::QuestionMark;
+                    types['+'] = TokenType::Plus;
+                    types['-'] = TokenType::Minus;
+                    types['*'] = TokenType::Star;
+                    types['%'] = TokenType::Percent;
+                    types['$'] = TokenType::DollarSign;
+                    return types;
+                }();
+                auto type = singleCharacterTokens[static_cast<uint8_t>(c)];
+                if (type != TokenType::None) {
+                    advance(1);
+                    return makeToken(type, start);
+                }
+                logError("Unexpected character '", consume(), "'");
+                continue;
+            }
 
-        if (token.type != TokenType::None) {
-            return token;
+            case CharacterClass::Invalid: logError("Unexpected character '", consume(), "'"); continue;
         }
     }
 
-    return Token(TokenType::EndOfFile, "", {currentPosition, currentPosition, line, column}, source_ptr);
+    return makeToken(TokenType::EndOfFile, currentPosition);
 }
 
-#undef SIMPLE_TOKEN
-#undef ENCLOSING_TOKEN
-#undef SET_TOKEN
-#undef COMPLEX_SET_TOKEN
-
 
 std::vector<Token> Tokenizer::tokenize() {
+    auto tokens = tokenizeQuietly();
+
     resetErrorCount();
     setErrorLimit(20);
-
+    for (auto const& error : errors) {
+        Error(error);
+    }
+    if (getErrorCount()) {
+        Fatal("Encountered ", getErrorCount(), " error", getErrorCount() == 1 ? "" : "s");
+    }
+    return tokens;
+}
+std::vector<Token> Tokenizer::tokenizeQuietly() {
     std::vector<Token> tokens;
     while (!isAtEnd()) {
         auto tok = nextToken();
         if (tok.type != TokenType::Comment) tokens.push_back(tok);
     }
-    tokens.push_back(Token(TokenType::EndOfFile, "", {currentPosition, currentPosition, line, column}, source_ptr));
-    if (getErrorCount()) {
-        Fatal("Encountered ", getErrorCount(), " error", getErrorCount() == 1 ? "" : "s");
-    }
+    tokens.push_back(makeToken(TokenType::EndOfFile, currentPosition));
     return tokens;
 }
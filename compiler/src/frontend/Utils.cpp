@@ -1,12 +1,14 @@
 #include "R-Sharp/Utils.hpp"
 #include "R-Sharp/frontend/Utils.hpp"
+#include "R-Sharp/frontend/SourceFile.hpp"
 #include "R-Sharp/Logging.hpp"
 
 #include "ANSI/ANSI.hpp"
 
+#include <algorithm>
 #include <sstream>
 
-std::string escapeString(std::string const& str) {
+std::string escapeString(std::string_view str) {
     std::string result;
     for (char c : str) {
         switch (c) {
@@ -22,64 +24,56 @@ std::string escapeString(std::string const& str) {
     return result;
 }
 
-std::vector<Token> cleanTokens(std::vector<Token> const& tokens) {
-    std::vector<Token> result;
-    for (auto const& token : tokens) {
-        if (token.type != TokenType::Comment) {
-            result.push_back(token);
-        }
-    }
-    return result;
+void cleanTokens(std::vector<Token>& tokens) {
+    tokens.erase(
+        std::remove_if(
+            tokens.begin(), tokens.end(), [](Token const& token) { return token.type == TokenType::Comment; }
+        ),
+        tokens.end()
+    );
 }
 
-void printErrorToken(Token token, std::string const& source) {
-    int start = token.position.startPos;
-    int end = token.position.endPos;
+void printErrorToken(Token const& token) {
+    if (!token.source) return;
+    auto const& file = *token.source;
+
+    auto [line, column] = file.getLocation(token.position.startPos);
+    const auto lineNumberWidth = std::to_string(line).length();
 
-    std::string src = source;
-    src.replace(start, end - start, ANSI::set4BitColor(ANSI::Red) + src.substr(start, end - start) + ANSI::reset());
+    // the highlighted part of the error line
+    auto errorLine = file.getLine(line);
+    auto lineStart = file.getLineStart(line);
+    auto highlightStart = std::min(token.position.startPos - lineStart, errorLine.size());
+    auto highlightEnd = std::clamp(token.position.endPos - lineStart, highlightStart, errorLine.size());
 
     // print the error and 3 lines above it
     std::stringstream ss;
-    int line = 1;
-    int column = 1;
-    int pos = 0;
+    for (int i = std::max(1, line - 3); i <= line; i++) {
+        auto text = file.getLine(i);
+        auto lineNumber = std::to_string(i);
+        // print some spacing to align the code
+        ss << lineNumber << std::string(lineNumberWidth - lineNumber.length(), ' ') << "| ";
 
-    for (char c : src) {
-        if (line >= token.position.line - 3 && line <= token.position.line) {
-            if (column == 1) {
-                ss << line;
-                // print some spacing to align the code
-                for (int i = 0; i < std::to_string(token.position.line).length() - std::to_string(line).length(); i++) {
-                    ss << " ";
-                }
-                ss << "| ";
-            }
-            if (line == token.position.line && c == '\n')
-                break;
-            ss << c;
-        }
-        pos++;
-        if (c == '\n') {
-            line++;
-            column = 1;
-        }
-        else {
-            column++;
+        if (i < line) {
+            ss << text << "\n";
+            continue;
         }
+        ss << text.substr(0, highlightStart) << ANSI::set4BitColor(ANSI::Red)
+           << text.substr(highlightStart, highlightEnd - highlightStart) << ANSI::reset()
+           << text.substr(highlightEnd);
     }
 
-    int prefixLen = (std::to_string(token.position.line) + "| ").length();
+    int prefixLen = lineNumberWidth + std::string("| ").length();
 
     ss << "\n"
-       << ANSI::set4BitColor(ANSI::Red)                           // enable red text
-       << std::string(prefixLen + token.position.column - 1, ' ') // print spaces before the error
+       << ANSI::set4BitColor(ANSI::Red)            // enable red text
+       << std::string(prefixLen + column - 1, ' ') // print spaces before the error
        << "^";
-    try {
+    size_t end = token.position.endPos;
+    size_t start = token.position.startPos;
+    if (end > start + 1) {
         ss << std::string(end - start - 1, '~'); // underline the error
     }
-    catch (std::length_error) {
-    }
 
     ss << ANSI::reset(); // disable red text
     Print(ss.str());
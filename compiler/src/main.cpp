@@ -2,6 +2,11 @@
 #include <string>
 #include <fstream>
 #include <filesystem>
+#include <cstdlib>
+#include <algorithm>
+#include <cctype>
+#include <set>
+#include <sstream>
 
 #include "R-Sharp/Logging.hpp"
 
@@ -23,6 +28,9 @@
 #include "R-Sharp/backend/RSIToAssembly.hpp"
 #include "R-Sharp/backend/Architecture.hpp"
 #include "R-Sharp/backend/RSIPass.hpp"
+#include "R-Sharp/Utils/ScopeGuard.hpp"
+#include "R-Sharp/Utils/Statistics.hpp"
+#include "R-Sharp/Utils/Trace.hpp"
 
 enum class ReturnValue {
     NormalExit = 0,
@@ -42,6 +50,17 @@ void printHelp(const char* programName) {
   --compiler <path>         Use this compiler. Default: "gcc"
   --link <file>             Additionally link <file> into the output. Can be repeated.
   --stdlib <path>           Use the standard library at <path>.
+  --regalloc=<allocator>    Register allocator for RSI formats (graph, linear). Default: "graph"
+  --assembler=<assembler>   Assembler for rsi_nasm (internal, nasm). Default: "internal"
+                              nasm writes the assembly to <output>.asm and assembles it with nasm
+  -j <jobs>                 Number of threads used to parse imports and process functions. Default: 1
+  -v, --verbose             Report the progress of the compilation. Repeat (-vv) for debug output.
+  --dump=<list>             Print intermediate results, a comma separated list of:
+                              tokens, ast, typed-ast, code, rsi (after every RSI pass)
+                              and rsi:<pass> (after a single RSI pass, e.g. rsi:liveness-analysis)
+  --time-passes             Print the time, allocations and peak memory of every phase of the compilation
+  --stats=<format>[:<file>] Like --time-passes, in the format table or json. Written to <file> if given.
+  --trace=<file>            Write a Chrome trace (chrome://tracing, Perfetto) of the compilation to <file>
 
 Return values:
   0     Everything OK
@@ -58,9 +77,50 @@ enum class OutputFormat {
     AArch64,
     RSI_NASM,
     RSI_AArch64,
+    // an x86-64 object file, assembled by the compiler itself
+    ELF,
 };
 
-int main(int argc, const char** argv) {
+/*
+The intermediate results to print, see --dump.
+*/
+struct DumpOptions {
+    bool tokens = false;
+    bool ast = false;
+    bool typedAst = false;
+    bool code = false;
+    bool allRsiPasses = false;
+    std::set<std::string> rsiPasses;
+};
+
+// the name of an RSI pass on the command line, "Liveness analysis" is "liveness-analysis"
+std::string toPassName(std::string const& humanHeader) {
+    std::string name;
+    for (char c : humanHeader) {
+        name += c == ' ' ? '-' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return name;
+}
+
+bool parseDumpOptions(std::string const& list, DumpOptions& options) {
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item == "tokens") options.tokens = true;
+        else if (item == "ast") options.ast = true;
+        else if (item == "typed-ast") options.typedAst = true;
+        else if (item == "code") options.code = true;
+        else if (item == "rsi") options.allRsiPasses = true;
+        else if (item.rfind("rsi:", 0) == 0) options.rsiPasses.insert(toPassName(item.substr(4)));
+        else {
+            Error("Unknown dump \"" + item + "\"");
+            return false;
+        }
+    }
+    return true;
+}
+
+int compile(int argc, const char** argv) {
     std::string inputFilename;
     std::string outputFilename = "a.out";
     OutputFormat outputFormat = OutputFormat::C;
@@ -68,6 +128,15 @@ int main(int argc, const char** argv) {
     std::string compiler = "gcc";
     std::vector<std::string> additionalyLinkedFiles;
     std::string stdlibIncludePath = std::filesystem::path(argv[0]).replace_filename("stdlib/");
+    bool useLinearScan = false;
+    bool useInternalAssembler = true;
+    size_t jobs = 1;
+    DumpOptions dumpOptions;
+    // empty if no statistics are collected
+    std::string statisticsFormat;
+    std::string statisticsFile;
+    // empty if the compilation isn't traced
+    std::string traceFile;
 
     if (argc < 2) {
         printHelp(argv[0]);
@@ -151,6 +220,71 @@ int main(int argc, const char** argv) {
                 return static_cast<int>(ReturnValue::UnknownError);
             }
         }
+        else if (arg.rfind("--regalloc=", 0) == 0) {
+            std::string allocator = arg.substr(std::string("--regalloc=").length());
+            if (allocator == "graph") {
+                useLinearScan = false;
+            }
+            else if (allocator == "linear") {
+                useLinearScan = true;
+            }
+            else {
+                Error("Unknown register allocator \"" + allocator + "\"");
+                return static_cast<int>(ReturnValue::UnknownError);
+            }
+        }
+        else if (arg.rfind("--assembler=", 0) == 0) {
+            std::string assembler = arg.substr(std::string("--assembler=").length());
+            if (assembler == "internal") {
+                useInternalAssembler = true;
+            }
+            else if (assembler == "nasm") {
+                useInternalAssembler = false;
+            }
+            else {
+                Error("Unknown assembler \"" + assembler + "\"");
+                return static_cast<int>(ReturnValue::UnknownError);
+            }
+        }
+        else if (arg == "-v" || arg == "--verbose") {
+            setLogLevel(isLogLevelEnabled(LogLevel::Verbose) ? LogLevel::Debug : LogLevel::Verbose);
+        }
+        else if (arg == "-vv") {
+            setLogLevel(LogLevel::Debug);
+        }
+        else if (arg.rfind("--dump=", 0) == 0) {
+            if (!parseDumpOptions(arg.substr(std::string("--dump=").length()), dumpOptions)) {
+                return static_cast<int>(ReturnValue::UnknownError);
+            }
+        }
+        else if (arg == "--time-passes") {
+            statisticsFormat = "table";
+        }
+        else if (arg.rfind("--stats=", 0) == 0) {
+            std::string value = arg.substr(std::string("--stats=").length());
+            auto colon = value.find(':');
+            statisticsFormat = value.substr(0, colon);
+            statisticsFile = colon == std::string::npos ? "" : value.substr(colon + 1);
+            if (statisticsFormat != "table" && statisticsFormat != "json") {
+                Error("Unknown statistics format \"" + statisticsFormat + "\"");
+                return static_cast<int>(ReturnValue::UnknownError);
+            }
+        }
+        else if (arg.rfind("--trace=", 0) == 0) {
+            traceFile = arg.substr(std::string("--trace=").length());
+            if (traceFile.empty()) {
+                Error("Missing trace file");
+                return static_cast<int>(ReturnValue::UnknownError);
+            }
+        }
+        else if (arg == "-j") {
+            char* end = nullptr;
+            if (i + 1 < argc) jobs = std::strtoul(argv[++i], &end, 10);
+            if (end == nullptr || *end != '\0' || jobs == 0) {
+                Error("Missing or invalid number of jobs");
+                return static_cast<int>(ReturnValue::UnknownError);
+            }
+        }
         else {
             // test if it is a filename
             if (std::filesystem::exists(arg)) {
@@ -166,88 +300,119 @@ int main(int argc, const char** argv) {
     std::vector<Token> tokens;
     std::shared_ptr<AstProgram> ast;
     std::string outputSource;
-    std::string R_Sharp_Source;
+    ThreadPool threadPool(jobs);
+
+    // the reports cover failed compilations as well, Fatal() unwinds up to main()
+    if (!traceFile.empty()) Trace::get().enable();
+    ScopeGuard traceReport([&]() {
+        if (!traceFile.empty() && !Trace::get().write(traceFile)) Error("Could not open file: ", traceFile);
+    });
+    if (!statisticsFormat.empty()) Statistics::get().enable();
+    ScopeGuard statisticsReport([&]() {
+        if (statisticsFormat.empty()) return;
+
+        std::ofstream file;
+        if (!statisticsFile.empty()) {
+            file.open(statisticsFile);
+            if (!file.is_open()) {
+                Error("Could not open file: ", statisticsFile);
+                return;
+            }
+        }
+        std::ostream& stream = file.is_open() ? file : std::cout;
+        if (statisticsFormat == "json") Statistics::get().printJson(stream);
+        else Statistics::get().printTable(stream);
+    });
 
-    Print("--------------| Tokenizing |--------------");
+    Verbose("--------------| Tokenizing |--------------");
     {
+        auto phase = Statistics::get().phase("Tokenizing");
         Tokenizer tokenizer(inputFilename);
         tokens = tokenizer.tokenize();
-        R_Sharp_Source = tokenizer.getSource();
 
-        for (auto const& token : tokens) {
-            Print(token.toString());
+        if (dumpOptions.tokens) {
+            Print("--------------| Tokens |--------------");
+            for (auto const& token : tokens) {
+                Print(token.toString());
+            }
         }
 
-        tokens = cleanTokens(tokens);
+        cleanTokens(tokens);
     }
 
-    Print("--------------| Parsing |--------------");
+    Verbose("--------------| Parsing |--------------");
     {
+        auto phase = Statistics::get().phase("Parsing");
         ParsingCache cache;
         Parser parser = Parser(tokens, inputFilename, stdlibIncludePath, cache);
+        {
+            auto importPhase = Statistics::get().phase("Import resolution");
+            parser.preloadImports(threadPool);
+        }
         ast = parser.parse();
 
-        Print("--------------| Syntax Errors |--------------");
         if (parser.hasErrors()) {
-            ErrorPrinter printer(ast, inputFilename, R_Sharp_Source);
+            ErrorPrinter printer(ast, inputFilename);
             printer.print();
             Error("Parsing errors.");
             return static_cast<int>(ReturnValue::SyntaxError);
         }
-        else {
-            Print("No errors");
-        }
     }
-    Print("--------------| Raw AST |--------------");
-    {
+    if (dumpOptions.ast) {
+        Print("--------------| Raw AST |--------------");
         AstPrinter printer(ast);
         printer.print();
     }
 
-    Print("--------------| Semantic Errors |--------------");
+    Verbose("--------------| Semantic analysis |--------------");
     {
-        SemanticValidator validator(ast, inputFilename, R_Sharp_Source);
+        auto phase = Statistics::get().phase("Semantic analysis");
+        SemanticValidator validator(ast, inputFilename);
         validator.validate();
 
         if (validator.hasErrors()) {
             Error("Semantic errors.");
             return static_cast<int>(ReturnValue::SemanticError);
         }
-        else {
-            Print("No errors");
-        }
     }
-    Print("--------------| Typed AST |--------------");
-    {
+    if (dumpOptions.typedAst) {
+        Print("--------------| Typed AST |--------------");
         AstPrinter printer(ast);
         printer.print();
     }
 
 
     RSI::TranslationUnit translationUnit;
-    Print("--------------| Generated code |--------------");
+    Verbose("--------------| Generating code |--------------");
     {
+        auto phase = Statistics::get().phase("Code generation");
         switch (outputFormat) {
             case OutputFormat::C:    outputSource = CCodeGenerator(ast).generate(); break;
-            case OutputFormat::NASM: outputSource = NASMCodeGenerator(ast, R_Sharp_Source).generate(); break;
+            case OutputFormat::NASM: outputSource = NASMCodeGenerator(ast).generate(); break;
             case OutputFormat::AArch64:
-                outputSource = AArch64CodeGenerator(ast, R_Sharp_Source).generate();
+                outputSource = AArch64CodeGenerator(ast).generate();
                 break;
             case OutputFormat::RSI_NASM:
             case OutputFormat::RSI_AArch64:
-                translationUnit = RSIGenerator(ast, R_Sharp_Source).generate();
+            // only chosen after the RSI passes, generated like rsi_nasm
+            case OutputFormat::ELF:
+                translationUnit = RSIGenerator(ast).generate();
                 break;
         }
-        if (outputSource.length())
-            Print(outputSource);
+        if (outputSource.length()) {
+            if (dumpOptions.code) {
+                Print("--------------| Generated code |--------------");
+                Print(outputSource);
+            }
+        }
         else {
             // clang-format off
             std::vector<RSIPass> passes = {
                 RSIPass{
                     .humanHeader = "Raw RSI",
                     .architectures = allArchitectureTypes,
-                    .positiveInstructionTypes = {RSI::InstructionType::NOP},
-                    .perInstructionFunction = [](auto&, auto&, auto&){},
+                    .isFunctionWide = true,
+                    .perFunctionFunction = [](auto&, auto&){},
                 },
                 /*
                 RSIPass{
@@ -272,73 +437,37 @@ int main(int argc, const char** argv) {
                     .humanHeader = "Seperate calls",
                     .architectures = {OutputArchitecture::x86_64},
                     .positiveInstructionTypes = {RSI::InstructionType::CALL},
-                    .perInstructionFunction = std::bind(
-                        RSI::seperateCallResults,
-                        x86_64,
-                        std::placeholders::_1,
-                        std::placeholders::_2,
-                        std::placeholders::_3
-                    ),
+                    .perInstructionFunction = [](auto& instr, auto& before, auto& after) { RSI::seperateCallResults(x86_64, instr, before, after); },
                 },
                 RSIPass{
                     .humanHeader = "Seperate calls",
                     .architectures = {OutputArchitecture::AArch64},
                     .positiveInstructionTypes = {RSI::InstructionType::CALL},
-                    .perInstructionFunction = std::bind(
-                        RSI::seperateCallResults,
-                        aarch64,
-                        std::placeholders::_1,
-                        std::placeholders::_2,
-                        std::placeholders::_3
-                    ),
+                    .perInstructionFunction = [](auto& instr, auto& before, auto& after) { RSI::seperateCallResults(aarch64, instr, before, after); },
                 },
                 RSIPass{
                     .humanHeader = "Separate parameter loads",
                     .architectures = {OutputArchitecture::x86_64},
                     .positiveInstructionTypes = {RSI::InstructionType::LOAD_PARAMETER},
-                    .perInstructionFunction = std::bind(
-                        RSI::separateLoadParameters,
-                        x86_64,
-                        std::placeholders::_1,
-                        std::placeholders::_2,
-                        std::placeholders::_3
-                    ),
+                    .perInstructionFunction = [](auto& instr, auto& before, auto& after) { RSI::separateLoadParameters(x86_64, instr, before, after); },
                 },
                 RSIPass{
                     .humanHeader = "Separate parameter loads",
                     .architectures = {OutputArchitecture::AArch64},
                     .positiveInstructionTypes = {RSI::InstructionType::LOAD_PARAMETER},
-                    .perInstructionFunction = std::bind(
-                        RSI::separateLoadParameters,
-                        aarch64,
-                        std::placeholders::_1,
-                        std::placeholders::_2,
-                        std::placeholders::_3
-                    ),
+                    .perInstructionFunction = [](auto& instr, auto& before, auto& after) { RSI::separateLoadParameters(aarch64, instr, before, after); },
                 },
                 RSIPass{
                     .humanHeader = "Resolve addresses",
                     .architectures = {OutputArchitecture::AArch64},
                     .positiveInstructionTypes = {RSI::InstructionType::ADDRESS_OF},
-                    .perInstructionFunction = std::bind(
-                        RSI::resolveAddressOf,
-                        aarch64,
-                        std::placeholders::_1,
-                        std::placeholders::_2,
-                        std::placeholders::_3
-                    ),
+                    .perInstructionFunction = [](auto& instr, auto& before, auto& after) { RSI::resolveAddressOf(aarch64, instr, before, after); },
                 },
                 RSIPass{
                     .humanHeader = "Resolve addresses",
                     .architectures = {OutputArchitecture::x86_64},
                     .positiveInstructionTypes = {RSI::InstructionType::ADDRESS_OF},
-                    .perInstructionFunction = std::bind(
-                        RSI::resolveAddressOf,
-                        x86_64,
-                        std::placeholders::_1,
-                        std::placeholders::_2,
-                        std::placeholders::_3
-                    ),
+                    .perInstructionFunction = [](auto& instr, auto& before, auto& after) { RSI::resolveAddressOf(x86_64, instr, before, after); },
                 },
                 RSIPass{
                     .humanHeader = "Constants to references",
@@ -372,11 +501,19 @@ int main(int argc, const char** argv) {
                     .positiveInstructionTypes = {},
                     .isFunctionWide = true,
                     .perFunctionFunction = [](auto& func, auto){
-                        if (func.instructions.at(0).meta.liveVariablesBefore.size() != 0) {
+                        if (!func.instructions.at(0).meta.liveVariablesBefore.none()) {
                             Fatal("Function \"", func.name, "\" requires live variables before main code. This probably means some transformation is incorrect.");
                         }
                     },
                 },
+                useLinearScan ?
+                RSIPass{
+                    .humanHeader = "Linear scan register assignment",
+                    .architectures = allArchitectureTypes,
+                    .positiveInstructionTypes = {},
+                    .isFunctionWide = true,
+                    .perFunctionFunction = RSI::assignRegistersLinearScan,
+                } :
                 RSIPass{
                     .humanHeader = "Graph coloring register assignment",
                     .architectures = allArchitectureTypes,
@@ -400,33 +537,49 @@ int main(int argc, const char** argv) {
             // clang-format on
 
             for (auto& pass : passes) {
-                pass(translationUnit.functions, outputArchitecture);
+                pass.isDumped = dumpOptions.allRsiPasses || dumpOptions.rsiPasses.count(toPassName(pass.humanHeader));
+            }
+            for (auto const& name : dumpOptions.rsiPasses) {
+                bool exists = std::any_of(passes.begin(), passes.end(), [&](auto const& pass) {
+                    return toPassName(pass.humanHeader) == name;
+                });
+                if (!exists) Warning("There is no RSI pass \"", name, "\" to dump");
+            }
+
+            {
+                auto passesPhase = Statistics::get().phase("RSI passes");
+                RSIPassManager passManager(std::move(passes), outputArchitecture);
+                passManager.run(translationUnit.functions, threadPool);
             }
-            Print("--------------| RSI to assembly |--------------");
+            Verbose("--------------| RSI to assembly |--------------");
+            auto emissionPhase = Statistics::get().phase("RSI to assembly");
             if (outputArchitecture == OutputArchitecture::x86_64) {
-                outputSource =
-                    "; NASM code generated by R-Sharp compiler (using RSI)"
-                    "\n"
-                    "BITS 64\n"
-                    "section .text\n"
-                    "\n";
+                outputFormat = useInternalAssembler ? OutputFormat::ELF : OutputFormat::NASM;
+                // the internal assembler doesn't need the source, it is only generated to be dumped
+                if (outputFormat == OutputFormat::NASM || dumpOptions.code) {
+                    outputSource =
+                        "; NASM code generated by R-Sharp compiler (using RSI)"
+                        "\n"
+                        "BITS 64\n"
+                        "section .text\n"
+                        "\n";
 
-                for (auto label : translationUnit.externLabels) {
-                    outputSource += "extern " + label->name + "\n";
-                }
-                for (auto& func : translationUnit.functions) {
-                    outputSource += "global " + func.name + "\n";
-                    outputSource += rsiToNasm(func) + "\n";
+                    for (auto label : translationUnit.externLabels) {
+                        outputSource += "extern " + label->name + "\n";
+                    }
+                    for (auto& func : translationUnit.functions) {
+                        outputSource += "global " + func.name + "\n";
+                        outputSource += rsiToNasm(func) + "\n";
+                    }
+                    outputSource += "section .data\n";
+                    for (auto [ref, value] : translationUnit.initializedGlobalVariables) {
+                        outputSource += ref->name + ": dq " + std::to_string(value.value) + "\n";
+                    }
+                    outputSource += "section .bss\n";
+                    for (auto ref : translationUnit.uninitializedGlobalVariables) {
+                        outputSource += ref->name + ": resb 8\n";
+                    }
                 }
-                outputSource += "section .data\n";
-                for (auto [ref, value] : translationUnit.initializedGlobalVariables) {
-                    outputSource += ref->name + ": dq " + std::to_string(value.value) + "\n";
-                }
-                outputSource += "section .bss\n";
-                for (auto ref : translationUnit.uninitializedGlobalVariables) {
-                    outputSource += ref->name + ": resb 8\n";
-                }
-                outputFormat = OutputFormat::NASM;
             }
             else {
                 outputSource =
@@ -459,7 +612,18 @@ int main(int argc, const char** argv) {
                 }
                 outputFormat = OutputFormat::AArch64;
             }
-            Print(outputSource);
+            if (dumpOptions.code) {
+                Print("--------------| Generated code |--------------");
+                Print(outputSource);
+            }
+            if (outputFormat == OutputFormat::ELF) {
+                auto object = rsiToElfObject(translationUnit);
+                if (!object) {
+                    Error("Assembling failed.");
+                    return static_cast<int>(ReturnValue::AssemblingError);
+                }
+                outputSource = std::move(*object);
+            }
         }
     }
     std::string temporaryFile = outputFilename;
@@ -467,21 +631,25 @@ int main(int argc, const char** argv) {
         case OutputFormat::C:       temporaryFile += ".c"; break;
         case OutputFormat::NASM:    temporaryFile += ".asm"; break;
         case OutputFormat::AArch64: temporaryFile += ".S"; break;
+        case OutputFormat::ELF:     temporaryFile += ".o"; break;
         default:
             Error("Unknown output format");
             return static_cast<int>(ReturnValue::UnknownError);
             break;
     }
 
-    Print("Writing to file: ", temporaryFile);
-    std::ofstream outputFile(temporaryFile);
-    if (outputFile.is_open()) {
-        outputFile << outputSource;
-        outputFile.close();
-    }
-    else {
-        Error("Could not open file: ", temporaryFile);
-        return static_cast<int>(ReturnValue::UnknownError);
+    Verbose("Writing to file: ", temporaryFile);
+    {
+        auto phase = Statistics::get().phase("Writing output");
+        std::ofstream outputFile(temporaryFile, std::ios::binary);
+        if (outputFile.is_open()) {
+            outputFile << outputSource;
+            outputFile.close();
+        }
+        else {
+            Error("Could not open file: ", temporaryFile);
+            return static_cast<int>(ReturnValue::UnknownError);
+        }
     }
 
     std::string additionalyLinkedFiles_str;
@@ -495,15 +663,21 @@ int main(int argc, const char** argv) {
     const std::string gccArgumentsLink = "-g -Werror -Wall -no-pie ";
     const std::string nasmArgumentsCompile = "-g -w+error";
 
+    // runs an external tool as a phase of its own, true on success
+    auto execute = [](std::string const& tool, std::string const& command) {
+        auto phase = Statistics::get().phase(tool);
+        Verbose("Executing: ", command);
+        return system(command.c_str()) == 0;
+    };
+
     switch (outputFormat) {
         case OutputFormat::C: {
-            Print("--------------| Compiling using gcc |--------------");
+            Verbose("--------------| Compiling using gcc |--------------");
             std::string command = compiler + " " + gccArgumentsCompile + " " + temporaryFile + " "
                                 + additionalyLinkedFiles_str + " -o " + outputFilename;
-            Print("Executing: ", command);
-            int success = !system(command.c_str());
+            int success = execute("gcc", command);
             if (success)
-                Print("Compilation successful.");
+                Verbose("Compilation successful.");
             else {
                 Error("Compilation failed.");
                 return static_cast<int>(ReturnValue::AssemblingError);
@@ -511,13 +685,12 @@ int main(int argc, const char** argv) {
             break;
         }
         case OutputFormat::AArch64: {
-            Print("--------------| Compiling using gcc |--------------");
+            Verbose("--------------| Compiling using gcc |--------------");
             std::string command = compiler + " " + gccArgumentsCompile + " " + temporaryFile + " "
                                 + additionalyLinkedFiles_str + " -o " + outputFilename;
-            Print("Executing: ", command);
-            int success = !system(command.c_str());
+            int success = execute("gcc", command);
             if (success)
-                Print("Compilation successful.");
+                Verbose("Compilation successful.");
             else {
                 Error("Compilation failed.");
                 return static_cast<int>(ReturnValue::AssemblingError);
@@ -525,25 +698,23 @@ int main(int argc, const char** argv) {
             break;
         }
         case OutputFormat::NASM: {
-            Print("--------------| Assembling using nasm |--------------");
+            Verbose("--------------| Assembling using nasm |--------------");
             std::string command = "nasm " + nasmArgumentsCompile + " -f elf64 " + temporaryFile + " -o "
                                 + outputFilename + ".o";
-            Print("Executing: ", command);
-            int success = !system(command.c_str());
+            int success = execute("nasm", command);
             if (success)
-                Print("Assembling successful.");
+                Verbose("Assembling successful.");
             else {
                 Error("Assembling failed.");
                 return static_cast<int>(ReturnValue::AssemblingError);
             }
 
-            Print("--------------| Linking using gcc |--------------");
+            Verbose("--------------| Linking using gcc |--------------");
             command = compiler + " " + gccArgumentsLink + " " + outputFilename + ".o "
                     + additionalyLinkedFiles_str + " -o " + outputFilename;
-            Print("Executing: ", command);
-            success = !system(command.c_str());
+            success = execute("gcc", command);
             if (success)
-                Print("Linking successful.");
+                Verbose("Linking successful.");
             else {
                 Error("Linking failed.");
                 return static_cast<int>(ReturnValue::AssemblingError);
@@ -551,6 +722,19 @@ int main(int argc, const char** argv) {
 
             break;
         }
+        case OutputFormat::ELF: {
+            Verbose("--------------| Linking using gcc |--------------");
+            std::string command = compiler + " " + gccArgumentsLink + " " + temporaryFile + " "
+                                + additionalyLinkedFiles_str + " -o " + outputFilename;
+            int success = execute("gcc", command);
+            if (success)
+                Verbose("Linking successful.");
+            else {
+                Error("Linking failed.");
+                return static_cast<int>(ReturnValue::AssemblingError);
+            }
+            break;
+        }
         default:
             Error("Unsupported output format");
             return static_cast<int>(ReturnValue::UnknownError);
@@ -559,3 +743,15 @@ int main(int argc, const char** argv) {
 
     return static_cast<int>(ReturnValue::NormalExit);
 }
+
+int main(int argc, const char** argv) {
+    // Fatal() throws instead of exiting, so the compilation unwinds and still writes its reports
+    Internals::fatalErrorsThrow = true;
+    try {
+        return compile(argc, argv);
+    }
+    catch (FatalError const& error) {
+        printFatalError(error);
+        return static_cast<int>(ReturnValue::UnknownError);
+    }
+}
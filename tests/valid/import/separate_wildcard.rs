@@ -0,0 +1,10 @@
+/*
+executionExitCode: 47
+*/
+
+imported @ std::test::import::valid;
+* @ std::test::import::valid;
+
+main(): i32 {
+    return imported() + magic_number;
+}
@@ -0,0 +1,22 @@
+/*
+executionExitCode: 47
+*/
+
+a: i64 = 40;
+
+add(a: i64, b: i64): i64 {
+    return a + b;
+}
+
+main(): i32 {
+    b: i64 = 3;
+    {
+        b: i64 = 100;
+        {
+            a: i64 = b;
+            b = a + 1;
+        }
+        b = b - 101;
+    }
+    return add(a, b) + 4;
+}
@@ -0,0 +1,109 @@
+import argparse
+import os
+import random
+import subprocess
+import sys
+import tempfile
+import time
+
+# Compares the graph coloring and the linear scan register allocator of rsc.
+# Generates a program with many temporaries, compiles it with both allocators
+# and reports the compile time and the number of emitted instructions.
+#
+# usage: python3 regalloc_benchmark.py <path to rsc> [--functions N] [--statements N]
+
+
+def generate_program(functions, statements, seed):
+    rng = random.Random(seed)
+    lines = []
+    for f in range(functions):
+        lines.append(f"f{f}(a: i64, b: i64): i64 {{")
+        variables = ["a", "b"]
+        for s in range(statements):
+            r = rng.random()
+            v = rng.choice(variables)
+            w = rng.choice(variables)
+            if r < 0.4 or len(variables) < 6:
+                lines.append(f"    v{s}: i64 = {v} + {w} * {rng.randint(1, 9)};")
+                variables.append(f"v{s}")
+            elif r < 0.6:
+                lines.append(f"    if ({v} < {w}) {{ {v} = {v} - {w}; }} else {{ {w} = {w} + 1; }}")
+            elif r < 0.75:
+                lines.append(f"    for (k{s}: i64 = 0; k{s} < 3; k{s} = k{s} + 1) {{ {v} = {v} + k{s} * {w}; }}")
+            else:
+                lines.append(f"    {v} = ({v} - {w}) % 7 + {w} / 3;")
+        lines.append("    return " + " + ".join(variables[-8:]) + ";")
+        lines.append("}")
+    lines.append("main(): i32 {")
+    lines.append("    r: i64 = 0;")
+    for f in range(functions):
+        lines.append(f"    r = r + f{f}({f}, 3);")
+    lines.append("    return r % 256;")
+    lines.append("}")
+    return "\n".join(lines) + "\n"
+
+
+def count_instructions(assembly_file):
+    count = 0
+    in_macro = False
+    for line in open(assembly_file):
+        line = line.split(";", 1)[0].split("//", 1)[0].strip()
+        if line.startswith(".macro"):
+            in_macro = True
+        if in_macro:
+            in_macro = line != ".endm"
+            continue
+        if not line or line.endswith(":") or line.startswith("."):
+            continue
+        if line.split()[0] in ("BITS", "section", "global", "extern") or ": dq" in line or ": resb" in line:
+            continue
+        count += 1
+    return count
+
+
+def compile_with(rsc, source, output, allocator, output_format, repetitions):
+    extension = ".asm" if output_format == "rsi_nasm" else ".S"
+    # the instructions are counted in the assembly, which the internal assembler doesn't write
+    assembler = ["--assembler=nasm"] if output_format == "rsi_nasm" else []
+    best = None
+    for _ in range(repetitions):
+        start = time.perf_counter()
+        subprocess.run(
+            [rsc, "-f", output_format, *assembler, f"--regalloc={allocator}", "--compiler", "true", "-o", output, source],
+            stdout=subprocess.DEVNULL,
+            stderr=subprocess.DEVNULL,
+        )
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    if not os.path.exists(output + extension):
+        print(f"rsc didn't produce {output + extension}")
+        sys.exit(1)
+    return best, count_instructions(output + extension)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare the register allocators of rsc.")
+    parser.add_argument("rsc", help="path to the rsc executable")
+    parser.add_argument("--functions", type=int, default=5)
+    parser.add_argument("--statements", type=int, default=300)
+    parser.add_argument("--format", default="rsi_aarch64", choices=["rsi_nasm", "rsi_aarch64"])
+    parser.add_argument("--repetitions", type=int, default=3)
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as directory:
+        source = os.path.join(directory, "benchmark.rs")
+        with open(source, "w") as f:
+            f.write(generate_program(args.functions, args.statements, args.seed))
+
+        print(f"{args.functions} functions with {args.statements} statements each ({args.format})")
+        print(f"{'allocator':<10} {'time [s]':>10} {'instructions':>14}")
+        for allocator in ("graph", "linear"):
+            elapsed, instructions = compile_with(
+                args.rsc, source, os.path.join(directory, allocator), allocator, args.format, args.repetitions
+            )
+            print(f"{allocator:<10} {elapsed:>10.3f} {instructions:>14}")
+
+
+if __name__ == "__main__":
+    main()